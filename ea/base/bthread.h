@@ -191,7 +191,7 @@ namespace EA {
         }
 
     private:
-        bthread_t _tid;
+        bthread_t _tid{0};
         const bthread_attr_t *_attr = nullptr;
     };
 
@@ -26,6 +26,7 @@
 #include "ea/client/discovery.h"
 #include "ea/client/dumper.h"
 #include "ea/client/config_info_builder.h"
+#include "ea/client/utility.h"
 #include "nlohmann/json.hpp"
 
 namespace EA::cli {
@@ -299,7 +300,12 @@ namespace EA::cli {
         if (!s.ok()) {
             return s;
         }
-        s = file.write(res.config_infos(0).content());
+        std::string content;
+        s = EA::client::get_config_content(res.config_infos(0), content);
+        if (!s.ok()) {
+            return s;
+        }
+        s = file.write(content);
         if (!s.ok()) {
             return s;
         }
@@ -442,7 +448,10 @@ namespace EA::cli {
         result_table.add_row(turbo::Table::Row_t{"type", config_type_to_string(config.type())});
         last = result_table.size() - 1;
         result_table[last].format().font_color(turbo::Color::green);
-        result_table.add_row(turbo::Table::Row_t{"size", turbo::Format(config.content().size())});
+        /// the size of the plain content, not the compressed one on the wire
+        std::string content;
+        auto rs = EA::client::get_config_content(config, content);
+        result_table.add_row(turbo::Table::Row_t{"size", rs.ok() ? turbo::Format(content.size()) : rs.message()});
         last = result_table.size() - 1;
         result_table[last].format().font_color(turbo::Color::green);
         turbo::Time cs = turbo::FromTimeT(config.time());
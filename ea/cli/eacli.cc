@@ -21,6 +21,7 @@
 #include "ea/client/router_sender.h"
 #include "ea/client/discovery_sender.h"
 #include "ea/cli/raft_cmd.h"
+#include "ea/cli/rocks_cmd.h"
 #include "ea/cli/discovery.h"
 
 int main(int argc, char **argv) {
@@ -88,6 +89,7 @@ int main(int argc, char **argv) {
     // lambda function
     EA::cli::RaftCmd::setup_raft_cmd(app);
     EA::cli::DiscoveryCmd::setup_discovery_cmd(app);
+    EA::cli::RocksCmd::setup_rocks_cmd(app);
     // More setup if needed, i.e., other subcommands etc.
 
     TURBO_FLAGS_PARSE(app, argc, argv);
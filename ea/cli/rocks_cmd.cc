@@ -0,0 +1,133 @@
+// Copyright 2023 The Elastic Architecture Infrastructure Authors.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "ea/cli/rocks_cmd.h"
+#include "ea/cli/show_help.h"
+#include "turbo/format/print.h"
+#include "turbo/strings/str_join.h"
+#include "turbo/strings/str_split.h"
+#include <algorithm>
+#include <brpc/channel.h>
+#include <brpc/controller.h>
+
+namespace EA::cli {
+
+    /// the gflags RocksStorage applies at runtime, see RocksStorage::collect_rocks_options
+    static const std::vector<std::string> kDynamicRocksOptions = {
+            "level0_file_num_compaction_trigger",
+            "slowdown_write_sst_cnt",
+            "stop_write_sst_cnt",
+            "rocks_hard_pending_compaction_g",
+            "rocks_soft_pending_compaction_g",
+            "target_file_size_base",
+            "rocks_level_multiplier",
+            "max_write_buffer_number",
+            "write_buffer_size",
+            "max_bytes_for_level_base",
+            "rocks_max_background_compactions",
+            "rocks_max_subcompactions",
+            "max_background_jobs"
+    };
+
+    void RocksCmd::setup_rocks_cmd(turbo::App &app) {
+        auto opt = RocksOptionContext::get_instance();
+        auto *ns = app.add_subcommand("rocks", "rocksdb options of discovery server");
+        ns->callback([ns]() { run_rocks_cmd(ns); });
+
+        ns->add_option("-m,--discovery_server", opt->discovery_server, "server address default(\"127.0.0.1:8010\")")->default_val(
+                "127.0.0.1:8010");
+        ns->add_option("-t,--timeout", opt->timeout_ms, "timeout ms default(2000)")->default_val(2000);
+
+        auto cg = ns->add_subcommand("get", "get rocksdb options");
+        cg->add_option("-n,--name", opt->option_names, "option names, all dynamic options if not set");
+        cg->callback([]() { run_get_cmd(); });
+
+        auto cs = ns->add_subcommand("set", "set rocksdb option");
+        cs->add_option("-n,--name", opt->option_name, "option name")->required();
+        cs->add_option("-v,--value", opt->option_value, "option value")->required();
+        cs->callback([]() { run_set_cmd(); });
+    }
+
+    void RocksCmd::run_rocks_cmd(turbo::App *app) {
+        if (app->get_subcommands().empty()) {
+            turbo::Println("{}", app->help());
+        }
+    }
+
+    void RocksCmd::run_get_cmd() {
+        ScopeShower ss;
+        auto opt = RocksOptionContext::get_instance();
+        auto &names = opt->option_names.empty() ? kDynamicRocksOptions : opt->option_names;
+        auto rs = http_get("/flags/" + turbo::StrJoin(names, ","));
+        if (!rs.ok()) {
+            ss.add_table("rpc", std::string(rs.status().message()), false);
+            return;
+        }
+        ss.add_table("rpc", "ok", true);
+        ss.add_table("summary", show_flags_result(rs.value()), true);
+    }
+
+    void RocksCmd::run_set_cmd() {
+        ScopeShower ss;
+        auto opt = RocksOptionContext::get_instance();
+        if (std::find(kDynamicRocksOptions.begin(), kDynamicRocksOptions.end(), opt->option_name) ==
+            kDynamicRocksOptions.end()) {
+            ss.add_table("prepare", turbo::Format("{} is not a dynamic rocksdb option", opt->option_name), false);
+            return;
+        }
+        ss.add_table("prepare", "ok", true);
+        auto rs = http_get(turbo::Format("/flags/{}?setvalue={}", opt->option_name, opt->option_value));
+        if (!rs.ok()) {
+            ss.add_table("rpc", std::string(rs.status().message()), false);
+            return;
+        }
+        ss.add_table("rpc", "ok", true);
+        ss.add_table("result", rs.value(), true);
+    }
+
+    turbo::ResultStatus<std::string> RocksCmd::http_get(const std::string &uri) {
+        auto opt = RocksOptionContext::get_instance();
+        brpc::ChannelOptions channel_opt;
+        channel_opt.protocol = brpc::PROTOCOL_HTTP;
+        channel_opt.timeout_ms = opt->timeout_ms;
+        brpc::Channel channel;
+        if (channel.Init(opt->discovery_server.c_str(), &channel_opt) != 0) {
+            return turbo::UnavailableError("init channel to {} fail", opt->discovery_server);
+        }
+        brpc::Controller cntl;
+        cntl.http_request().uri() = uri;
+        channel.CallMethod(nullptr, &cntl, nullptr, nullptr, nullptr);
+        if (cntl.Failed()) {
+            /// a refused value is answered with an error code and the reason in the body
+            std::string body = cntl.response_attachment().to_string();
+            return turbo::UnavailableError("{} {}", cntl.ErrorText(), body);
+        }
+        return cntl.response_attachment().to_string();
+    }
+
+    turbo::Table RocksCmd::show_flags_result(const std::string &body) {
+        turbo::Table summary;
+        summary.add_row({"name", "value", "description", "defined"});
+        std::vector<std::string> lines = turbo::StrSplit(body, '\n', turbo::SkipEmpty());
+        for (auto &line : lines) {
+            std::vector<std::string> fields = turbo::StrSplit(line, " | ");
+            /// the header line of brpc, and the lines not of a flag
+            if (fields.size() < 4 || fields[0] == "Name") {
+                continue;
+            }
+            summary.add_row({fields[0], fields[1], fields[2], fields[3]});
+        }
+        return summary;
+    }
+}  // namespace EA::cli
@@ -0,0 +1,57 @@
+// Copyright 2023 The Elastic Architecture Infrastructure Authors.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef EA_CLI_ROCKS_CMD_H_
+#define EA_CLI_ROCKS_CMD_H_
+
+#include "turbo/flags/flags.h"
+#include "turbo/format/table.h"
+#include "turbo/base/result_status.h"
+#include <string>
+#include <vector>
+
+namespace EA::cli {
+
+    struct RocksOptionContext {
+        static RocksOptionContext *get_instance() {
+            static RocksOptionContext ins;
+            return &ins;
+        }
+        std::string discovery_server;
+        int64_t timeout_ms{2000};
+        std::vector<std::string> option_names;
+        std::string option_name;
+        std::string option_value;
+    };
+
+    /// the rocksdb options of a discovery server are its gflags, read and set through the
+    /// builtin /flags service of brpc, the server applies a new value to the running db
+    struct RocksCmd {
+
+        static void setup_rocks_cmd(turbo::App &app);
+
+        static void run_rocks_cmd(turbo::App *app);
+
+        static void run_get_cmd();
+
+        static void run_set_cmd();
+
+        static turbo::ResultStatus<std::string> http_get(const std::string &uri);
+
+        static turbo::Table show_flags_result(const std::string &body);
+    };
+
+}  // namespace EA::cli
+
+#endif  // EA_CLI_ROCKS_CMD_H_
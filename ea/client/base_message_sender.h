@@ -16,11 +16,21 @@
 #ifndef EA_CLIENT_BASE_MESSAGE_SENDER_H_
 #define EA_CLIENT_BASE_MESSAGE_SENDER_H_
 
+#include <functional>
 #include "turbo/base/status.h"
 #include "eapi/discovery/discovery.interface.pb.h"
+#include "ea/base/bthread.h"
+#include "ea/flags/client.h"
 
 namespace EA::client {
 
+    /**
+     * @ingroup ea_rpc
+     * @brief SenderCallback is called once an asynchronous request is finished, with the status of the request.
+     *        the response is ready to use only if the status is ok.
+     */
+    typedef std::function<void(const turbo::Status &status)> SenderCallback;
+
     /**
      * @ingroup ea_rpc
      * @brief BaseMessageSender is the interface for sending messages to the meta server.
@@ -66,6 +76,96 @@ namespace EA::client {
          */
         virtual turbo::Status discovery_query(const EA::discovery::DiscoveryQueryRequest &request,
                                          EA::discovery::DiscoveryQueryResponse &response) = 0;
+
+        /**
+         * @brief async_discovery_manager is the asynchronous version of discovery_manager, it returns at once and
+         *        calls callback when the request is finished. request and response must be valid until then.
+         *        The default implementation runs discovery_manager in a background bthread.
+         * @param request [input] is the DiscoveryManagerRequest to send.
+         * @param response [output] is the MetaManagerResponse received from the meta server.
+         * @param callback [input] is called with the result of the request.
+         * @param retry_times [input] is the number of times to retry sending the request.
+         */
+        virtual void async_discovery_manager(const EA::discovery::DiscoveryManagerRequest *request,
+                                             EA::discovery::DiscoveryManagerResponse *response,
+                                             const SenderCallback &callback, int retry_times) {
+            EA::Bthread bth;
+            bth.run([this, request, response, callback, retry_times]() {
+                callback(discovery_manager(*request, *response, retry_times));
+            });
+        }
+
+        /**
+         * @brief async_discovery_manager is the asynchronous version of discovery_manager, it returns at once and
+         *        calls callback when the request is finished. request and response must be valid until then.
+         *        The default implementation runs discovery_manager in a background bthread.
+         * @param request [input] is the DiscoveryManagerRequest to send.
+         * @param response [output] is the MetaManagerResponse received from the meta server.
+         * @param callback [input] is called with the result of the request.
+         */
+        virtual void async_discovery_manager(const EA::discovery::DiscoveryManagerRequest *request,
+                                             EA::discovery::DiscoveryManagerResponse *response,
+                                             const SenderCallback &callback) {
+            EA::Bthread bth;
+            bth.run([this, request, response, callback]() {
+                callback(discovery_manager(*request, *response));
+            });
+        }
+
+        /**
+         * @brief async_discovery_query is the asynchronous version of discovery_query, it returns at once and
+         *        calls callback when the request is finished. request and response must be valid until then.
+         *        The default implementation runs discovery_query in a background bthread.
+         * @param request [input] is the DiscoveryQueryRequest to send.
+         * @param response [output] is the DiscoveryQueryResponse received from the meta server.
+         * @param callback [input] is called with the result of the request.
+         * @param retry_times [input] is the number of times to retry sending the request.
+         */
+        virtual void async_discovery_query(const EA::discovery::DiscoveryQueryRequest *request,
+                                           EA::discovery::DiscoveryQueryResponse *response,
+                                           const SenderCallback &callback, int retry_times) {
+            EA::Bthread bth;
+            bth.run([this, request, response, callback, retry_times]() {
+                callback(discovery_query(*request, *response, retry_times));
+            });
+        }
+
+        /**
+         * @brief async_discovery_query is the asynchronous version of discovery_query, it returns at once and
+         *        calls callback when the request is finished. request and response must be valid until then.
+         *        The default implementation runs discovery_query in a background bthread.
+         * @param request [input] is the DiscoveryQueryRequest to send.
+         * @param response [output] is the DiscoveryQueryResponse received from the meta server.
+         * @param callback [input] is called with the result of the request.
+         */
+        virtual void async_discovery_query(const EA::discovery::DiscoveryQueryRequest *request,
+                                           EA::discovery::DiscoveryQueryResponse *response,
+                                           const SenderCallback &callback) {
+            EA::Bthread bth;
+            bth.run([this, request, response, callback]() {
+                callback(discovery_query(*request, *response));
+            });
+        }
+
+    protected:
+        /**
+         * @brief call_timeout_ms is used to get the timeout of one call of the request. The watch queries are
+         *        held by the server until a change or its watch timeout, they need a longer timeout than the
+         *        other requests.
+         * @return the timeout in milliseconds, 0 to use the timeout of the sender.
+         */
+        template<typename Request>
+        static int32_t call_timeout_ms(const Request &) {
+            return 0;
+        }
+
+        static int32_t call_timeout_ms(const EA::discovery::DiscoveryQueryRequest &request) {
+            if (request.op_type() == EA::discovery::QUERY_INSTANCE_WATCH ||
+                request.op_type() == EA::discovery::QUERY_WATCH_CONFIG) {
+                return FLAGS_discovery_watch_rpc_timeout_ms;
+            }
+            return 0;
+        }
     };
 }  // namespace EA::client
 
@@ -0,0 +1,380 @@
+// Copyright 2023 The Elastic Architecture Infrastructure Authors.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "ea/client/cache_file.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <bthread/bthread.h>
+#include <butil/crc32c.h>
+#include <butil/errno.h>
+#include <butil/time.h>
+#include "ea/flags/client.h"
+#include "ea/base/tlog.h"
+
+namespace EA::client {
+
+    static const char kCacheFileMagic[8] = {'E', 'A', 'C', 'A', 'C', 'H', 'E', '1'};
+    static const uint8_t kRecordPut = 1;
+    static const uint8_t kRecordRemove = 2;
+    /// crc32c(4) type(1) reserved(3) key size(4) value size(4)
+    static const size_t kRecordHeaderSize = 16;
+    static const uint64_t kCompactMinDeadBytes = 1024 * 1024;
+
+    static bool write_all(int fd, const char *data, size_t size, off_t offset) {
+        while (size > 0) {
+            ssize_t n = ::pwrite(fd, data, size, offset);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += n;
+            size -= n;
+            offset += n;
+        }
+        return true;
+    }
+
+    static bool read_all(int fd, char *data, size_t size, off_t offset) {
+        while (size > 0) {
+            ssize_t n = ::pread(fd, data, size, offset);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            data += n;
+            size -= n;
+            offset += n;
+        }
+        return true;
+    }
+
+    static std::string make_record(uint8_t type, std::string_view key, std::string_view value) {
+        std::string record(kRecordHeaderSize + key.size() + value.size(), '\0');
+        uint32_t key_size = key.size();
+        uint32_t value_size = value.size();
+        char *p = record.data();
+        p[4] = static_cast<char>(type);
+        memcpy(p + 8, &key_size, sizeof(key_size));
+        memcpy(p + 12, &value_size, sizeof(value_size));
+        memcpy(p + kRecordHeaderSize, key.data(), key.size());
+        memcpy(p + kRecordHeaderSize + key.size(), value.data(), value.size());
+        uint32_t crc = butil::crc32c::Value(p + 4, record.size() - 4);
+        memcpy(p, &crc, sizeof(crc));
+        return record;
+    }
+
+    CacheFile::~CacheFile() {
+        close();
+    }
+
+    turbo::Status CacheFile::open(const std::string &path, const RecordVisitor &visitor) {
+        std::unique_lock lock(_file_mutex);
+        if (_fd >= 0) {
+            return turbo::AlreadyExistsError("cache file {} is opened", _path);
+        }
+        _path = path;
+        if (::access(path.c_str(), F_OK) != 0) {
+            /// create it with the header in a temp file, a crash never leaves a file without header
+            std::string tmp_path = path + ".tmp";
+            int fd = ::open(tmp_path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+            if (fd < 0) {
+                return turbo::UnavailableError("create cache file {} fail:{}", tmp_path, berror());
+            }
+            bool ok = write_all(fd, kCacheFileMagic, sizeof(kCacheFileMagic), 0) && ::fdatasync(fd) == 0;
+            ::close(fd);
+            if (!ok || ::rename(tmp_path.c_str(), path.c_str()) != 0) {
+                return turbo::UnavailableError("create cache file {} fail:{}", path, berror());
+            }
+            sync_dir();
+        }
+        _fd = ::open(path.c_str(), O_RDWR);
+        if (_fd < 0) {
+            return turbo::UnavailableError("open cache file {} fail:{}", path, berror());
+        }
+        return load(visitor);
+    }
+
+    turbo::Status CacheFile::load(const RecordVisitor &visitor) {
+        struct stat st;
+        if (::fstat(_fd, &st) != 0) {
+            return turbo::UnavailableError("stat cache file {} fail:{}", _path, berror());
+        }
+        uint64_t size = st.st_size;
+        if (size < sizeof(kCacheFileMagic)) {
+            TLOG_WARN("cache file {} has no header, reset it", _path);
+            if (::ftruncate(_fd, 0) != 0 || !write_all(_fd, kCacheFileMagic, sizeof(kCacheFileMagic), 0)) {
+                return turbo::UnavailableError("reset cache file {} fail:{}", _path, berror());
+            }
+            _file_size = sizeof(kCacheFileMagic);
+            return turbo::OkStatus();
+        }
+        void *addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, _fd, 0);
+        if (addr == MAP_FAILED) {
+            return turbo::UnavailableError("mmap cache file {} fail:{}", _path, berror());
+        }
+        const char *base = static_cast<const char *>(addr);
+        if (memcmp(base, kCacheFileMagic, sizeof(kCacheFileMagic)) != 0) {
+            ::munmap(addr, size);
+            return turbo::DataLossError("cache file {} has a bad header", _path);
+        }
+        uint64_t offset = sizeof(kCacheFileMagic);
+        while (offset + kRecordHeaderSize <= size) {
+            const char *p = base + offset;
+            uint32_t crc;
+            uint32_t key_size;
+            uint32_t value_size;
+            memcpy(&crc, p, sizeof(crc));
+            memcpy(&key_size, p + 8, sizeof(key_size));
+            memcpy(&value_size, p + 12, sizeof(value_size));
+            uint64_t record_size = kRecordHeaderSize + key_size + value_size;
+            if (offset + record_size > size || butil::crc32c::Value(p + 4, record_size - 4) != crc) {
+                break;
+            }
+            std::string key(p + kRecordHeaderSize, key_size);
+            auto it = _index.find(key);
+            if (it != _index.end()) {
+                _live_bytes -= it->second.size;
+                _dead_bytes += it->second.size;
+            }
+            if (static_cast<uint8_t>(p[4]) == kRecordPut) {
+                _index[key] = Slot{offset, record_size};
+                _live_bytes += record_size;
+            } else {
+                if (it != _index.end()) {
+                    _index.erase(it);
+                }
+                _dead_bytes += record_size;
+            }
+            offset += record_size;
+        }
+        if (offset < size) {
+            TLOG_WARN("cache file {} has a torn record at {}, cut {} bytes", _path, offset, size - offset);
+            if (::ftruncate(_fd, offset) != 0) {
+                TLOG_WARN("truncate cache file {} fail:{}", _path, berror());
+            }
+        }
+        _file_size = offset;
+        /// only the live records are decoded
+        for (auto &it : _index) {
+            const char *p = base + it.second.offset;
+            uint32_t key_size;
+            uint32_t value_size;
+            memcpy(&key_size, p + 8, sizeof(key_size));
+            memcpy(&value_size, p + 12, sizeof(value_size));
+            visitor(std::string_view(p + kRecordHeaderSize, key_size),
+                    std::string_view(p + kRecordHeaderSize + key_size, value_size));
+        }
+        ::munmap(addr, size);
+        TLOG_INFO("load cache file {}, {} records, live bytes:{}, dead bytes:{}", _path, _index.size(),
+                  _live_bytes, _dead_bytes);
+        return turbo::OkStatus();
+    }
+
+    turbo::Status CacheFile::put(std::string_view key, std::string_view value) {
+        return append(kRecordPut, key, value);
+    }
+
+    turbo::Status CacheFile::get(std::string_view key, std::string *value) {
+        std::unique_lock lock(_file_mutex);
+        if (_fd < 0) {
+            return turbo::UnavailableError("cache file is not opened");
+        }
+        auto it = _index.find(std::string(key));
+        if (it == _index.end()) {
+            return turbo::NotFoundError("");
+        }
+        uint64_t value_offset = it->second.offset + kRecordHeaderSize + key.size();
+        value->resize(it->second.size - kRecordHeaderSize - key.size());
+        if (!read_all(_fd, value->data(), value->size(), value_offset)) {
+            return turbo::UnavailableError("read cache file {} fail:{}", _path, berror());
+        }
+        return turbo::OkStatus();
+    }
+
+    turbo::Status CacheFile::remove(std::string_view key) {
+        return append(kRecordRemove, key, std::string_view());
+    }
+
+    turbo::Status CacheFile::append(uint8_t type, std::string_view key, std::string_view value) {
+        /// encode before taking the lock
+        std::string record = make_record(type, key, value);
+        std::unique_lock lock(_file_mutex);
+        if (_fd < 0) {
+            return turbo::UnavailableError("cache file is not opened");
+        }
+        if (!write_all(_fd, record.data(), record.size(), _file_size)) {
+            /// a partial record is cut off at the next open by its checksum
+            return turbo::UnavailableError("write cache file {} fail:{}", _path, berror());
+        }
+        std::string skey(key);
+        auto it = _index.find(skey);
+        if (it != _index.end()) {
+            _live_bytes -= it->second.size;
+            _dead_bytes += it->second.size;
+        }
+        if (type == kRecordPut) {
+            _index[skey] = Slot{_file_size, record.size()};
+            _live_bytes += record.size();
+        } else {
+            if (it != _index.end()) {
+                _index.erase(it);
+            }
+            _dead_bytes += record.size();
+        }
+        _file_size += record.size();
+        _dirty = true;
+        schedule_sync();
+        if (_dead_bytes > kCompactMinDeadBytes && _dead_bytes > _live_bytes) {
+            auto rs = compact();
+            if (!rs.ok()) {
+                TLOG_WARN("compact cache file {} fail:{}", _path, rs.message());
+            }
+        }
+        return turbo::OkStatus();
+    }
+
+    turbo::Status CacheFile::compact() {
+        std::string tmp_path = _path + ".tmp";
+        int fd = ::open(tmp_path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+        if (fd < 0) {
+            return turbo::UnavailableError("create cache file {} fail:{}", tmp_path, berror());
+        }
+        turbo::flat_hash_map<std::string, Slot> index;
+        uint64_t offset = sizeof(kCacheFileMagic);
+        bool ok = write_all(fd, kCacheFileMagic, sizeof(kCacheFileMagic), 0);
+        std::string record;
+        for (auto it = _index.begin(); ok && it != _index.end(); ++it) {
+            record.resize(it->second.size);
+            ok = read_all(_fd, record.data(), record.size(), it->second.offset) &&
+                 write_all(fd, record.data(), record.size(), offset);
+            index[it->first] = Slot{offset, it->second.size};
+            offset += it->second.size;
+        }
+        ok = ok && ::fdatasync(fd) == 0;
+        ::close(fd);
+        if (!ok || ::rename(tmp_path.c_str(), _path.c_str()) != 0) {
+            ::unlink(tmp_path.c_str());
+            return turbo::UnavailableError("write cache file {} fail:{}", tmp_path, berror());
+        }
+        sync_dir();
+        int new_fd = ::open(_path.c_str(), O_RDWR);
+        if (new_fd < 0) {
+            return turbo::UnavailableError("open cache file {} fail:{}", _path, berror());
+        }
+        ::close(_fd);
+        _fd = new_fd;
+        TLOG_INFO("compact cache file {} from {} to {} bytes", _path, _file_size, offset);
+        _index.swap(index);
+        _file_size = offset;
+        _dead_bytes = 0;
+        _dirty = false;
+        return turbo::OkStatus();
+    }
+
+    void CacheFile::schedule_sync() {
+        if (_sync_pending) {
+            return;
+        }
+        if (FLAGS_config_cache_sync_interval_ms <= 0) {
+            ::fdatasync(_fd);
+            _dirty = false;
+            return;
+        }
+        _sync_pending = true;
+        if (bthread_timer_add(&_sync_timer, butil::milliseconds_from_now(FLAGS_config_cache_sync_interval_ms),
+                              on_sync_timer, this) != 0) {
+            _sync_pending = false;
+            ::fdatasync(_fd);
+            _dirty = false;
+        }
+    }
+
+    void CacheFile::on_sync_timer(void *arg) {
+        /// the timer thread should not be blocked by the disk
+        bthread_t tid;
+        if (bthread_start_background(&tid, nullptr, run_sync, arg) != 0) {
+            run_sync(arg);
+        }
+    }
+
+    void *CacheFile::run_sync(void *arg) {
+        auto self = static_cast<CacheFile *>(arg);
+        std::unique_lock lock(self->_file_mutex);
+        if (self->_fd >= 0 && self->_dirty) {
+            ::fdatasync(self->_fd);
+            self->_dirty = false;
+        }
+        /// close may be waiting for this, the file must not be touched after the lock is released
+        self->_sync_pending = false;
+        self->_sync_cond.notify_all();
+        return nullptr;
+    }
+
+    void CacheFile::sync() {
+        std::unique_lock lock(_file_mutex);
+        if (_fd >= 0 && _dirty) {
+            ::fdatasync(_fd);
+            _dirty = false;
+        }
+    }
+
+    void CacheFile::sync_dir() {
+        auto pos = _path.rfind('/');
+        std::string dir = pos == std::string::npos ? "." : (pos == 0 ? "/" : _path.substr(0, pos));
+        int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+        if (fd < 0) {
+            TLOG_WARN("open dir {} fail:{}", dir, berror());
+            return;
+        }
+        if (::fsync(fd) != 0) {
+            TLOG_WARN("fsync dir {} fail:{}", dir, berror());
+        }
+        ::close(fd);
+    }
+
+    void CacheFile::close() {
+        std::unique_lock lock(_file_mutex);
+        if (_fd < 0) {
+            return;
+        }
+        if (_sync_pending) {
+            if (bthread_timer_del(_sync_timer) == 0) {
+                _sync_pending = false;
+            } else {
+                /// the timer has fired, wait the sync running on this file
+                _sync_cond.wait(lock, [this] { return !_sync_pending; });
+            }
+        }
+        if (_dirty) {
+            ::fdatasync(_fd);
+        }
+        ::close(_fd);
+        _fd = -1;
+        _dirty = false;
+        _index.clear();
+        _file_size = 0;
+        _live_bytes = 0;
+        _dead_bytes = 0;
+    }
+
+}  // namespace EA::client
@@ -0,0 +1,140 @@
+// Copyright 2023 The Elastic Architecture Infrastructure Authors.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef EA_CLIENT_CACHE_FILE_H_
+#define EA_CLIENT_CACHE_FILE_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <bthread/unstable.h>
+#include "turbo/base/status.h"
+#include "turbo/container/flat_hash_map.h"
+
+namespace EA::client {
+
+    /**
+     * @ingroup config_client
+     * @brief CacheFile is a single append-only binary file of key/value records, used to persist the client caches.
+     *        Each record is [crc32c][type][key size][value size][key][value], a put of a key supersedes the
+     *        previous one and a remove appends a tombstone. The file is memory mapped and scanned once at open,
+     *        a torn record left by a crash is detected by the checksum and cut off. The records are written
+     *        at the end of the file without blocking the readers of the cache, fsync is batched by a timer of
+     *        FLAGS_config_cache_sync_interval_ms. When the dead records take more space than the live ones
+     *        the file is compacted into a temp file that is renamed over it.
+     * @code
+     *      CacheFile file;
+     *      auto rs = file.open("./config_cache/config.cache", [](std::string_view key, std::string_view value) {
+     *          ...
+     *      });
+     *      rs = file.put("key", "value");
+     *      rs = file.remove("key");
+     * @endcode
+     */
+    class CacheFile {
+    public:
+        typedef std::function<void(std::string_view key, std::string_view value)> RecordVisitor;
+
+        CacheFile() = default;
+
+        ~CacheFile();
+
+        CacheFile(const CacheFile &) = delete;
+
+        CacheFile &operator=(const CacheFile &) = delete;
+
+        /**
+         * @brief open is used to open or create the cache file, and visit the live records of it.
+         * @param path [input] is the path of the cache file.
+         * @param visitor [input] is called for each live record, the views are valid during the call only.
+         * @return Status::OK if the file was opened successfully. Otherwise, an error status is returned.
+         */
+        turbo::Status open(const std::string &path, const RecordVisitor &visitor);
+
+        /**
+         * @brief put is used to append a record of the key, it supersedes the previous record of the key.
+         * @param key [input] is the key of the record.
+         * @param value [input] is the value of the record.
+         * @return Status::OK if the record was written successfully. Otherwise, an error status is returned.
+         */
+        turbo::Status put(std::string_view key, std::string_view value);
+
+        /**
+         * @brief get is used to read the value of the live record of the key from the file.
+         * @param key [input] is the key of the record.
+         * @param value [output] is the value of the record.
+         * @return Status::OK if the record was read, NotFound if the key has no live record.
+         */
+        turbo::Status get(std::string_view key, std::string *value);
+
+        /**
+         * @brief remove is used to append a tombstone of the key.
+         * @param key [input] is the key of the record to remove.
+         * @return Status::OK if the tombstone was written successfully. Otherwise, an error status is returned.
+         */
+        turbo::Status remove(std::string_view key);
+
+        /**
+         * @brief sync is used to flush the records written to the disk.
+         */
+        void sync();
+
+        /**
+         * @brief close is used to sync and close the file.
+         */
+        void close();
+
+    private:
+        struct Slot {
+            uint64_t offset{0};
+            uint64_t size{0};
+        };
+
+        turbo::Status append(uint8_t type, std::string_view key, std::string_view value);
+
+        turbo::Status load(const RecordVisitor &visitor);
+
+        turbo::Status compact();
+
+        void schedule_sync();
+
+        static void on_sync_timer(void *arg);
+
+        static void *run_sync(void *arg);
+
+        /// makes the renames in the directory of the file durable
+        void sync_dir();
+
+    private:
+        std::mutex _file_mutex;
+        std::string _path;
+        int _fd{-1};
+        uint64_t _file_size{0};
+        uint64_t _live_bytes{0};
+        uint64_t _dead_bytes{0};
+        bool _dirty{false};
+        /// set from the timer is added until the sync of the timer is done
+        bool _sync_pending{false};
+        bthread_timer_t _sync_timer;
+        std::condition_variable _sync_cond;
+        /// key -> the live record of the key
+        turbo::flat_hash_map<std::string, Slot> _index;
+    };
+
+}  // namespace EA::client
+
+#endif  // EA_CLIENT_CACHE_FILE_H_
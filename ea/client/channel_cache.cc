@@ -0,0 +1,65 @@
+// Copyright 2023 The Elastic Architecture Infrastructure Authors.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "ea/client/channel_cache.h"
+#include "ea/flags/client.h"
+#include "ea/base/tlog.h"
+
+namespace EA::client {
+
+    void ChannelCache::set_timeout(int timeout_ms, int connect_timeout_ms) {
+        std::unique_lock lock(_channel_mutex);
+        _timeout_ms = timeout_ms;
+        _connect_timeout_ms = connect_timeout_ms;
+        _channels.clear();
+    }
+
+    std::shared_ptr<brpc::Channel> ChannelCache::get_channel(const butil::EndPoint &addr) {
+        return get_channel(std::string(butil::endpoint2str(addr).c_str()));
+    }
+
+    std::shared_ptr<brpc::Channel> ChannelCache::get_channel(const std::string &server) {
+        std::unique_lock lock(_channel_mutex);
+        auto it = _channels.find(server);
+        if (it != _channels.end()) {
+            return it->second;
+        }
+        brpc::ChannelOptions channel_opt;
+        channel_opt.timeout_ms = _timeout_ms;
+        channel_opt.connect_timeout_ms = _connect_timeout_ms;
+        channel_opt.connection_type = FLAGS_discovery_connection_type;
+        auto channel = std::make_shared<brpc::Channel>();
+        if (channel->Init(server.c_str(), &channel_opt) != 0) {
+            TLOG_WARN("init channel to {} fail, connection_type:{}", server, FLAGS_discovery_connection_type);
+            return nullptr;
+        }
+        _channels[server] = channel;
+        return channel;
+    }
+
+    void ChannelCache::remove_channel(const butil::EndPoint &addr) {
+        remove_channel(std::string(butil::endpoint2str(addr).c_str()));
+    }
+
+    void ChannelCache::remove_channel(const std::string &server) {
+        std::unique_lock lock(_channel_mutex);
+        _channels.erase(server);
+    }
+
+    void ChannelCache::clear() {
+        std::unique_lock lock(_channel_mutex);
+        _channels.clear();
+    }
+
+}  // namespace EA::client
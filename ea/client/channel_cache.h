@@ -0,0 +1,98 @@
+// Copyright 2023 The Elastic Architecture Infrastructure Authors.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef EA_CLIENT_CHANNEL_CACHE_H_
+#define EA_CLIENT_CHANNEL_CACHE_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <brpc/channel.h>
+#include <butil/endpoint.h>
+#include "turbo/container/flat_hash_map.h"
+
+namespace EA::client {
+
+    /**
+     * @ingroup ea_rpc
+     * @brief ChannelCache keeps one initialized brpc::Channel per server address, so that the senders
+     *        do not build a new channel and connection for every request and every retry.
+     *        The connection type of the channels is taken from FLAGS_discovery_connection_type
+     *        (single, pooled or short). It is thread safe, the channel returned stays valid while
+     *        it is held even if it is removed from the cache meanwhile.
+     * @code
+     *      ChannelCache cache;
+     *      cache.set_timeout(30000, 5000);
+     *      auto channel = cache.get_channel(addr);
+     *      if (!channel) {
+     *          return turbo::UnavailableError("");
+     *      }
+     *      channel->CallMethod(method, &cntl, &request, &response, nullptr);
+     *      if (cntl.Failed()) {
+     *          cache.remove_channel(addr);
+     *      }
+     * @endcode
+     */
+    class ChannelCache {
+    public:
+        ChannelCache() = default;
+
+        /**
+         * @brief set_timeout is used to set the timeouts of the channels, the cached channels are dropped.
+         * @param timeout_ms [input] is the request timeout in milliseconds.
+         * @param connect_timeout_ms [input] is the connect timeout in milliseconds.
+         */
+        void set_timeout(int timeout_ms, int connect_timeout_ms);
+
+        /**
+         * @brief get_channel is used to get the channel to the address, it is created on first use.
+         * @param addr [input] is the address of the server.
+         * @return the channel, or nullptr if the channel can not be initialized.
+         */
+        std::shared_ptr<brpc::Channel> get_channel(const butil::EndPoint &addr);
+
+        /**
+         * @brief get_channel is used to get the channel to the server, it is created on first use.
+         * @param server [input] is the server address, "ip:port" or "hostname:port".
+         * @return the channel, or nullptr if the channel can not be initialized.
+         */
+        std::shared_ptr<brpc::Channel> get_channel(const std::string &server);
+
+        /**
+         * @brief remove_channel is used to drop the channel of the address, eg after the server failed or lost leadership.
+         * @param addr [input] is the address of the server.
+         */
+        void remove_channel(const butil::EndPoint &addr);
+
+        /**
+         * @brief remove_channel is used to drop the channel of the server.
+         * @param server [input] is the server.
+         */
+        void remove_channel(const std::string &server);
+
+        /**
+         * @brief clear is used to drop all the cached channels.
+         */
+        void clear();
+
+    private:
+        std::mutex _channel_mutex;
+        int _timeout_ms{30000};
+        int _connect_timeout_ms{5000};
+        turbo::flat_hash_map<std::string, std::shared_ptr<brpc::Channel>> _channels;
+    };
+
+}  // namespace EA::client
+
+#endif  // EA_CLIENT_CHANNEL_CACHE_H_
@@ -15,15 +15,15 @@
 
 #include "ea/client/config_cache.h"
 #include "ea/flags/client.h"
-#include "ea/client/utility.h"
 #include "turbo/files/filesystem.h"
-#include "turbo/files/sequential_write_file.h"
-#include "turbo/files/sequential_read_file.h"
 #include "ea/client/loader.h"
-#include "ea/client/dumper.h"
+#include "turbo/strings/numbers.h"
+#include "turbo/strings/str_split.h"
 
 namespace EA::client {
 
+    static const char *kConfigCacheFile = "config.cache";
+
     turbo::Status ConfigCache::init() {
         if(_init) {
             return turbo::OkStatus();
@@ -38,65 +38,185 @@ namespace EA::client {
                 return turbo::UnknownError(ec.message());
             }
             turbo::filesystem::create_directories(_cache_dir);
-            return turbo::OkStatus();
         }
+        auto file_path = turbo::Format("{}/{}", _cache_dir, kConfigCacheFile);
+        /// only the keys are indexed, the content of a config is read and parsed on its first get
+        CacheType index;
+        auto rs = _cache_file.open(file_path, [&index](std::string_view key, std::string_view) {
+            std::string name;
+            turbo::ModuleVersion version;
+            if (!parse_cache_key(key, &name, &version)) {
+                TLOG_WARN("bad config cache key:{}", key);
+                return;
+            }
+            index[name].emplace(version, nullptr);
+        });
+        if(!rs.ok()) {
+            return rs;
+        }
+        _cache_map.Modify([&index](CacheType &cache) -> size_t {
+            cache = index;
+            return 1;
+        });
+        rs = load_legacy_files();
+        if(!rs.ok()) {
+            return rs;
+        }
+        _init = true;
+        return turbo::OkStatus();
+    }
+
+    turbo::Status ConfigCache::load_legacy_files() {
         turbo::filesystem::directory_iterator dir_itr(_cache_dir);
         turbo::filesystem::directory_iterator end;
         for(;dir_itr != end; ++dir_itr) {
-            if(dir_itr->path() == "." || dir_itr->path() == "..") {
+            auto file_name = dir_itr->path().filename().string();
+            auto ext = dir_itr->path().extension().string();
+            /// the cache files of CacheFile and their temp files
+            if(!dir_itr->is_regular_file() || ext == ".cache" || ext == ".tmp") {
                 continue;
             }
             auto file_path = dir_itr->path().string();
             EA::discovery::ConfigInfo info;
             auto rs = Loader::load_proto_from_file(file_path, info);
+            if(!rs.ok()) {
+                TLOG_WARN("skip config cache file:{}, {}", file_path, rs.message());
+                continue;
+            }
+            std::string value;
+            info.SerializeToString(&value);
+            auto version = turbo::ModuleVersion(info.version().major(), info.version().minor(),
+                                                info.version().patch());
+            rs = _cache_file.put(make_cache_key(info.name(), version), value);
             if(!rs.ok()) {
                 return rs;
             }
             do_add_config(info);
-            TLOG_INFO("loading config cache file:{}", file_path);
+            turbo::filesystem::remove(file_path);
+            TLOG_INFO("move config cache file:{} into {}", file_path, kConfigCacheFile);
         }
-        _init = true;
         return turbo::OkStatus();
     }
+
     turbo::Status ConfigCache::add_config(const EA::discovery::ConfigInfo &config) {
+        auto version = turbo::ModuleVersion(config.version().major(), config.version().minor(),
+                                            config.version().patch());
+        auto ptr = std::make_shared<const EA::discovery::ConfigInfo>(config);
+        bool exists = false;
+        /// called on the background copy, and on the other one after the swap if it returns non zero
+        _cache_map.Modify([&](CacheType &cache) -> size_t {
+            auto &slot = cache[config.name()][version];
+            /// a record not read yet is replaced, it may be the one that failed to parse
+            exists = slot != nullptr;
+            if (exists) {
+                return 0;
+            }
+            slot = ptr;
+            return 1;
+        });
+        if (exists) {
+            return turbo::AlreadyExistsError("");
+        }
+        if (_cache_dir.empty()) {
+            return turbo::OkStatus();
+        }
+        std::string value;
+        if (!config.SerializeToString(&value)) {
+            return turbo::InternalError("serialize config {} fail", config.name());
+        }
+        return _cache_file.put(make_cache_key(config.name(), version), value);
+    }
+
+    void ConfigCache::do_add_config(const EA::discovery::ConfigInfo &config) {
+        auto version = turbo::ModuleVersion(config.version().major(), config.version().minor(),
+                                            config.version().patch());
+        auto ptr = std::make_shared<const EA::discovery::ConfigInfo>(config);
+        _cache_map.Modify([&](CacheType &cache) -> size_t {
+            cache[config.name()][version] = ptr;
+            return 1;
+        });
+    }
+
+    std::shared_ptr<const EA::discovery::ConfigInfo>
+    ConfigCache::get_config(const std::string &name, const turbo::ModuleVersion &version) {
         {
-            std::unique_lock lock(_cache_mutex);
-            if (_cache_map.find(config.name()) == _cache_map.end()) {
-                _cache_map[config.name()] = std::map<turbo::ModuleVersion, EA::discovery::ConfigInfo>();
+            butil::DoublyBufferedData<CacheType>::ScopedPtr cache;
+            if (_cache_map.Read(&cache) != 0) {
+                return nullptr;
+            }
+            auto it = cache->find(name);
+            if (it == cache->end()) {
+                return nullptr;
             }
-            auto it = _cache_map.find(config.name());
-            auto version = turbo::ModuleVersion(config.version().major(), config.version().minor(),
-                                                config.version().patch());
-            if (it->second.find(version) != it->second.end()) {
-                return turbo::AlreadyExistsError("");
+            auto vit = it->second.find(version);
+            if (vit == it->second.end()) {
+                return nullptr;
+            }
+            if (vit->second) {
+                return vit->second;
             }
-            it->second[version] = config;
         }
-        return write_config_file(_cache_dir, config);
+        /// Modify waits for the readers, the read lock of this thread is released before it
+        return load_config(name, version);
     }
 
-    void ConfigCache::do_add_config(const EA::discovery::ConfigInfo &config) {
-            if (_cache_map.find(config.name()) == _cache_map.end()) {
-                _cache_map[config.name()] = std::map<turbo::ModuleVersion, EA::discovery::ConfigInfo>();
+    std::shared_ptr<const EA::discovery::ConfigInfo> ConfigCache::get_config(const std::string &name) {
+        turbo::ModuleVersion version;
+        {
+            butil::DoublyBufferedData<CacheType>::ScopedPtr cache;
+            if (_cache_map.Read(&cache) != 0) {
+                return nullptr;
+            }
+            auto it = cache->find(name);
+            if (it == cache->end() || it->second.empty()) {
+                return nullptr;
             }
-            auto it = _cache_map.find(config.name());
-            auto version = turbo::ModuleVersion(config.version().major(), config.version().minor(),
-                                                config.version().patch());
-            it->second[version] = config;
+            auto vit = it->second.rbegin();
+            if (vit->second) {
+                return vit->second;
+            }
+            version = vit->first;
+        }
+        return load_config(name, version);
     }
 
-    turbo::Status ConfigCache::get_config(const std::string &name, const turbo::ModuleVersion &version,
-                                          EA::discovery::ConfigInfo &config) {
-        std::unique_lock lock(_cache_mutex);
-        auto it = _cache_map.find(config.name());
-        if (it != _cache_map.end()) {
+    std::shared_ptr<const EA::discovery::ConfigInfo>
+    ConfigCache::load_config(const std::string &name, const turbo::ModuleVersion &version) {
+        std::string value;
+        auto rs = _cache_file.get(make_cache_key(name, version), &value);
+        if (!rs.ok()) {
+            TLOG_WARN("read config cache record {} fail:{}", name, rs.message());
+            return nullptr;
+        }
+        auto info = std::make_shared<EA::discovery::ConfigInfo>();
+        if (!info->ParseFromString(value)) {
+            TLOG_WARN("bad config cache record:{}", name);
+            return nullptr;
+        }
+        std::shared_ptr<const EA::discovery::ConfigInfo> ptr = std::move(info);
+        _cache_map.Modify([&](CacheType &cache) -> size_t {
+            auto it = cache.find(name);
+            if (it == cache.end()) {
+                return 0;
+            }
             auto vit = it->second.find(version);
-            if (vit != it->second.end()) {
-                config = vit->second;
-                return turbo::OkStatus();
+            if (vit == it->second.end() || vit->second) {
+                return 0;
             }
+            vit->second = ptr;
+            return 1;
+        });
+        return ptr;
+    }
+
+    turbo::Status ConfigCache::get_config(const std::string &name, const turbo::ModuleVersion &version,
+                                          EA::discovery::ConfigInfo &config) {
+        auto ptr = get_config(name, version);
+        if (!ptr) {
+            return turbo::NotFoundError("");
         }
-        return turbo::NotFoundError("");
+        config = *ptr;
+        return turbo::OkStatus();
     }
 
     ///
@@ -105,24 +225,23 @@ namespace EA::client {
     /// \param config
     /// \return
     turbo::Status ConfigCache::get_config(const std::string &name, EA::discovery::ConfigInfo &config) {
-        std::unique_lock lock(_cache_mutex);
-        auto it = _cache_map.find(config.name());
-        if (it != _cache_map.end()) {
-            auto vit = it->second.rbegin();
-            if (vit != it->second.rend()) {
-                config = vit->second;
-                return turbo::OkStatus();
-            }
+        auto ptr = get_config(name);
+        if (!ptr) {
+            return turbo::NotFoundError("");
         }
-        return turbo::NotFoundError("");
+        config = *ptr;
+        return turbo::OkStatus();
     }
 
     ///
     /// \param name
     /// \return
     turbo::Status ConfigCache::get_config_list(std::vector<std::string> &configs) {
-        std::unique_lock lock(_cache_mutex);
-        for (auto it = _cache_map.begin(); it != _cache_map.end(); ++it) {
+        butil::DoublyBufferedData<CacheType>::ScopedPtr cache;
+        if (_cache_map.Read(&cache) != 0) {
+            return turbo::UnavailableError("read config cache fail");
+        }
+        for (auto it = cache->begin(); it != cache->end(); ++it) {
             configs.push_back(it->first);
         }
         return turbo::OkStatus();
@@ -134,9 +253,12 @@ namespace EA::client {
     /// \return
     turbo::Status
     ConfigCache::get_config_version_list(const std::string &config_name, std::vector<turbo::ModuleVersion> &versions) {
-        std::unique_lock lock(_cache_mutex);
-        auto it = _cache_map.find(config_name);
-        if (it != _cache_map.end()) {
+        butil::DoublyBufferedData<CacheType>::ScopedPtr cache;
+        if (_cache_map.Read(&cache) != 0) {
+            return turbo::UnavailableError("read config cache fail");
+        }
+        auto it = cache->find(config_name);
+        if (it != cache->end()) {
             for (auto vit = it->second.begin(); vit != it->second.end(); ++vit) {
                 versions.push_back(vit->first);
             }
@@ -151,21 +273,10 @@ namespace EA::client {
     /// \param version
     /// \return
     turbo::Status ConfigCache::remove_config(const std::string &config_name, const turbo::ModuleVersion &version) {
-        std::unique_lock lock(_cache_mutex);
-        auto it = _cache_map.find(config_name);
-        if (it != _cache_map.end()) {
-            auto vit = it->second.find(version);
-            if (vit != it->second.end()) {
-                auto rs = remove_config_file(_cache_dir, vit->second);
-                TURBO_UNUSED(rs);
-                it->second.erase(vit);
-                if (it->second.empty()) {
-                    _cache_map.erase(it);
-                }
-                return turbo::OkStatus();
-            }
+        if (!get_config(config_name, version)) {
+            return turbo::NotFoundError("");
         }
-        return turbo::NotFoundError("");
+        return remove_config(config_name, std::vector<turbo::ModuleVersion>{version});
     }
 
     ///
@@ -174,23 +285,35 @@ namespace EA::client {
     /// \return
     turbo::Status
     ConfigCache::remove_config(const std::string &config_name, const std::vector<turbo::ModuleVersion> &versions) {
-        std::unique_lock lock(_cache_mutex);
-        auto it = _cache_map.find(config_name);
-        if (it != _cache_map.end()) {
+        std::vector<std::string> removed_keys;
+        bool found = false;
+        bool first = true;
+        _cache_map.Modify([&](CacheType &cache) -> size_t {
+            auto it = cache.find(config_name);
+            if (it == cache.end()) {
+                return 0;
+            }
+            found = true;
+            size_t removed = 0;
             for (auto &version: versions) {
-                auto vit = it->second.find(version);
-                if (vit != it->second.end()) {
-                    auto rs = remove_config_file(_cache_dir, vit->second);
-                    TURBO_UNUSED(rs);
-                    it->second.erase(vit);
+                if (it->second.erase(version) > 0) {
+                    ++removed;
+                    if (first) {
+                        removed_keys.push_back(make_cache_key(config_name, version));
+                    }
                 }
             }
             if (it->second.empty()) {
-                _cache_map.erase(it);
+                cache.erase(it);
             }
-            return turbo::OkStatus();
+            first = false;
+            return removed;
+        });
+        if (!found) {
+            return turbo::NotFoundError("");
         }
-        return turbo::NotFoundError("");
+        remove_cache_keys(removed_keys);
+        return turbo::OkStatus();
     }
 
     ///
@@ -200,21 +323,35 @@ namespace EA::client {
     /// \return
     turbo::Status
     ConfigCache::remove_config_less_than(const std::string &config_name, const turbo::ModuleVersion &version) {
-        std::unique_lock lock(_cache_mutex);
-        auto it = _cache_map.find(config_name);
-        if (it != _cache_map.end()) {
+        std::vector<std::string> removed_keys;
+        bool found = false;
+        bool first = true;
+        _cache_map.Modify([&](CacheType &cache) -> size_t {
+            auto it = cache.find(config_name);
+            if (it == cache.end()) {
+                return 0;
+            }
+            found = true;
             auto vit = it->second.lower_bound(version);
+            size_t removed = 0;
             for (auto rit = it->second.begin(); rit != vit; ++rit) {
-                auto rs = remove_config_file(_cache_dir, rit->second);
-                TURBO_UNUSED(rs);
+                ++removed;
+                if (first) {
+                    removed_keys.push_back(make_cache_key(config_name, rit->first));
+                }
             }
             it->second.erase(it->second.begin(), vit);
             if (it->second.empty()) {
-                _cache_map.erase(it);
+                cache.erase(it);
             }
-            return turbo::OkStatus();
+            first = false;
+            return removed;
+        });
+        if (!found) {
+            return turbo::NotFoundError("");
         }
-        return turbo::NotFoundError("");
+        remove_cache_keys(removed_keys);
+        return turbo::OkStatus();
     }
 
     ///
@@ -222,42 +359,62 @@ namespace EA::client {
     /// \param config_name
     /// \return
     turbo::Status ConfigCache::remove_config(const std::string &config_name) {
-        std::unique_lock lock(_cache_mutex);
-        auto it = _cache_map.find(config_name);
-        if (it != _cache_map.end()) {
-            for (auto &vit: it->second) {
-                auto rs = remove_config_file(_cache_dir, vit.second);
-                TURBO_UNUSED(rs);
+        std::vector<std::string> removed_keys;
+        bool first = true;
+        _cache_map.Modify([&](CacheType &cache) -> size_t {
+            auto it = cache.find(config_name);
+            if (it == cache.end()) {
+                return 0;
             }
-            _cache_map.erase(it);
-            return turbo::OkStatus();
+            if (first) {
+                for (auto &vit: it->second) {
+                    removed_keys.push_back(make_cache_key(config_name, vit.first));
+                }
+            }
+            cache.erase(it);
+            first = false;
+            return 1;
+        });
+        if (removed_keys.empty()) {
+            return turbo::NotFoundError("");
         }
-        return turbo::NotFoundError("");
+        remove_cache_keys(removed_keys);
+        return turbo::OkStatus();
     }
 
-    turbo::Status ConfigCache::write_config_file(const std::string &dir, const EA::discovery::ConfigInfo &config) {
-        if (dir.empty()) {
-            return turbo::OkStatus();
+    void ConfigCache::remove_cache_keys(const std::vector<std::string> &keys) {
+        if (_cache_dir.empty()) {
+            return;
+        }
+        for (auto &key : keys) {
+            auto rs = _cache_file.remove(key);
+            if (!rs.ok()) {
+                TLOG_WARN("remove config cache record {} fail:{}", key, rs.message());
+            }
         }
-        auto file_path = make_cache_file_path(dir, config);
-        return EA::client::Dumper::dump_proto_to_file(file_path, config);
     }
 
-    turbo::Status ConfigCache::remove_config_file(const std::string &dir, const EA::discovery::ConfigInfo &config) {
-        if (dir.empty()) {
-            return turbo::OkStatus();
-        }
-        auto file_path = make_cache_file_path(dir, config);
-        turbo::filesystem::remove(file_path);
-        return turbo::OkStatus();
+    std::string ConfigCache::make_cache_key(const std::string &name, const turbo::ModuleVersion &version) {
+        return turbo::Format("{}@{}.{}.{}", name, version.major, version.minor, version.patch);
     }
 
-    std::string ConfigCache::make_cache_file_path(const std::string &dir, const EA::discovery::ConfigInfo &config) {
-        return turbo::Format("{}/{}-{}.{}.{}.{}", dir,
-                             config.name(),
-                             config.version().minor(),
-                             config.version().minor(),
-                             config.version().patch(),
-                             config_type_to_string(config.type()));
+    bool ConfigCache::parse_cache_key(std::string_view key, std::string *name, turbo::ModuleVersion *version) {
+        auto pos = key.rfind('@');
+        if (pos == std::string_view::npos) {
+            return false;
+        }
+        std::vector<std::string_view> parts = turbo::StrSplit(key.substr(pos + 1), '.');
+        uint32_t numbers[3];
+        if (parts.size() != 3) {
+            return false;
+        }
+        for (size_t i = 0; i < parts.size(); ++i) {
+            if (!turbo::SimpleAtoi(parts[i], &numbers[i])) {
+                return false;
+            }
+        }
+        name->assign(key.data(), pos);
+        *version = turbo::ModuleVersion(numbers[0], numbers[1], numbers[2]);
+        return true;
     }
-}  // namespace EA::client
\ No newline at end of file
+}  // namespace EA::client
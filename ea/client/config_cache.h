@@ -17,11 +17,14 @@
 
 #include "turbo/container/flat_hash_map.h"
 #include <map>
-#include <mutex>
+#include <memory>
+#include <string_view>
+#include <butil/containers/doubly_buffered_data.h>
 #include "turbo/base/status.h"
 #include "turbo/module/module_version.h"
 #include "eapi/discovery/discovery.struct.pb.h"
 #include "ea/base/bthread.h"
+#include "ea/client/cache_file.h"
 
 namespace EA::client {
 
@@ -29,6 +32,11 @@ namespace EA::client {
      * @ingroup config_client
      * @brief ConfigCache is used to cache the config files downloaded from the meta server.
      *        It is used by the DiscoveryClient to cache the config files downloaded from the meta server.
+     *        The configs are immutable shared_ptr<const ConfigInfo>, published through a DoublyBufferedData
+     *        map, so the lookups take no shared lock and copy nothing but the pointer. The writers are
+     *        serialized by the DoublyBufferedData. The configs are persisted in one binary CacheFile under
+     *        FLAGS_config_cache_dir, written after the cache is updated. At init only the keys of the file are
+     *        indexed, a config is read from the file and parsed on its first get.
      */
     class ConfigCache {
     public:
@@ -60,6 +68,15 @@ namespace EA::client {
         turbo::Status
         get_config(const std::string &name, const turbo::ModuleVersion &version, EA::discovery::ConfigInfo &config);
 
+        /**
+         * @brief get_config is used to get a config that matches the name and version from the ConfigCache without copying it.
+         * @param name [input] is the name of the config to get.
+         * @param version [input] is the version of the config to get.
+         * @return the config, or nullptr if it is not cached. It stays valid while held.
+         */
+        std::shared_ptr<const EA::discovery::ConfigInfo>
+        get_config(const std::string &name, const turbo::ModuleVersion &version);
+
         /**
          * @brief get_config is used to get the latest version of a config from the ConfigCache.
          * @param name [input] is the name of the config to get the latest version for.
@@ -68,6 +85,13 @@ namespace EA::client {
          */
         turbo::Status get_config(const std::string &name, EA::discovery::ConfigInfo &config);
 
+        /**
+         * @brief get_config is used to get the latest version of a config from the ConfigCache without copying it.
+         * @param name [input] is the name of the config to get the latest version for.
+         * @return the config, or nullptr if it is not cached. It stays valid while held.
+         */
+        std::shared_ptr<const EA::discovery::ConfigInfo> get_config(const std::string &name);
+
         /**
          * @brief get_config_list is used to get a list of config names from the ConfigCache.
          * @param name [output] is the list of config names received from the ConfigCache.
@@ -118,28 +142,31 @@ namespace EA::client {
     private:
 
         /**
-         *
-         * @param dir
-         * @param config
-         * @return
+         * @brief make_cache_key is used to make the key of the config in the cache file, name@major.minor.patch.
          */
-        turbo::Status write_config_file(const std::string &dir, const EA::discovery::ConfigInfo &config);
+        static std::string make_cache_key(const std::string &name, const turbo::ModuleVersion &version);
 
         /**
-         *
-         * @param dir
-         * @param config
-         * @return
+         * @brief parse_cache_key is used to get the name and the version of the config from its cache key.
          */
-        turbo::Status remove_config_file(const std::string &dir, const EA::discovery::ConfigInfo &config);
+        static bool parse_cache_key(std::string_view key, std::string *name, turbo::ModuleVersion *version);
 
         /**
-         *
-         * @param dir
-         * @param config
-         * @return
+         * @brief load_config is used to read and parse a config indexed at init, and publish it in the cache.
+         * @return the config, or nullptr if the record can not be read or parsed.
+         */
+        std::shared_ptr<const EA::discovery::ConfigInfo>
+        load_config(const std::string &name, const turbo::ModuleVersion &version);
+
+        /**
+         * @brief load_legacy_files is used to move the json files of the old cache into the cache file.
+         */
+        turbo::Status load_legacy_files();
+
+        /**
+         * @brief remove_cache_keys is used to remove the configs from the cache file, out of the cache lock.
          */
-        std::string make_cache_file_path(const std::string &dir, const EA::discovery::ConfigInfo &config);
+        void remove_cache_keys(const std::vector<std::string> &keys);
 
         /**
          *
@@ -148,9 +175,10 @@ namespace EA::client {
         void do_add_config(const EA::discovery::ConfigInfo &config);
 
     private:
-        typedef turbo::flat_hash_map<std::string, std::map<turbo::ModuleVersion, EA::discovery::ConfigInfo>> CacheType;
-        std::mutex _cache_mutex;
-        CacheType _cache_map;
+        typedef std::map<turbo::ModuleVersion, std::shared_ptr<const EA::discovery::ConfigInfo>> VersionMap;
+        typedef turbo::flat_hash_map<std::string, VersionMap> CacheType;
+        butil::DoublyBufferedData<CacheType> _cache_map;
+        CacheFile _cache_file;
         std::string _cache_dir;
         bool        _init{false};
     };
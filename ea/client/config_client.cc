@@ -55,21 +55,27 @@ namespace EA::client {
         if (!rs.ok()) {
             return rs;
         }
-        EA::discovery::ConfigInfo config_pb;
-        rs = ConfigCache::get_instance()->get_config(config_name, mv, config_pb);
-        if (rs.ok()) {
-            content = config_pb.content();
+        auto cached = ConfigCache::get_instance()->get_config(config_name, mv);
+        if (cached) {
+            rs = get_config_content(*cached, content);
+            if (!rs.ok()) {
+                return rs;
+            }
             if (type) {
-                *type = config_type_to_string(config_pb.type());
+                *type = config_type_to_string(cached->type());
             }
             return turbo::OkStatus();
         }
 
+        EA::discovery::ConfigInfo config_pb;
         rs = DiscoveryClient::get_instance()->get_config(config_name, version, config_pb);
         if (!rs.ok()) {
             return rs;
         }
-        content = config_pb.content();
+        rs = get_config_content(config_pb, content);
+        if (!rs.ok()) {
+            return rs;
+        }
         if (type) {
             *type = config_type_to_string(config_pb.type());
         }
@@ -79,25 +85,30 @@ namespace EA::client {
 
     turbo::Status ConfigClient::get_config(const std::string &config_name, std::string &content, std::string *version,
                                            std::string *type) {
-        turbo::ModuleVersion mv;
-        EA::discovery::ConfigInfo config_pb;
-        auto rs = ConfigCache::get_instance()->get_config(config_name, config_pb);
-        if (rs.ok()) {
-            content = config_pb.content();
+        auto cached = ConfigCache::get_instance()->get_config(config_name);
+        if (cached) {
+            auto rs = get_config_content(*cached, content);
+            if (!rs.ok()) {
+                return rs;
+            }
             if (type) {
-                *type = config_type_to_string(config_pb.type());
+                *type = config_type_to_string(cached->type());
             }
             if (version) {
-                *version = version_to_string(config_pb.version());
+                *version = version_to_string(cached->version());
             }
             return turbo::OkStatus();
         }
 
-        rs = DiscoveryClient::get_instance()->get_config_latest(config_name, config_pb);
+        EA::discovery::ConfigInfo config_pb;
+        auto rs = DiscoveryClient::get_instance()->get_config_latest(config_name, config_pb);
+        if (!rs.ok()) {
+            return rs;
+        }
+        rs = get_config_content(config_pb, content);
         if (!rs.ok()) {
             return rs;
         }
-        content = config_pb.content();
         if (type) {
             *type = config_type_to_string(config_pb.type());
         }
@@ -108,6 +119,50 @@ namespace EA::client {
         return rs;
     }
 
+    turbo::Status ConfigClient::get_configs(const std::vector<std::pair<std::string, std::string>> &name_versions,
+                                            std::vector<EA::discovery::ConfigInfo> &configs) {
+        configs.clear();
+        configs.resize(name_versions.size());
+        std::vector<size_t> miss_index;
+        std::vector<std::pair<std::string, std::string>> miss_name_versions;
+        for (size_t i = 0; i < name_versions.size(); ++i) {
+            auto &name = name_versions[i].first;
+            auto &version = name_versions[i].second;
+            turbo::Status rs;
+            if (version.empty()) {
+                rs = ConfigCache::get_instance()->get_config(name, configs[i]);
+            } else {
+                turbo::ModuleVersion mv;
+                rs = string_to_module_version(version, &mv);
+                if (!rs.ok()) {
+                    return rs;
+                }
+                rs = ConfigCache::get_instance()->get_config(name, mv, configs[i]);
+            }
+            if (!rs.ok()) {
+                miss_index.push_back(i);
+                miss_name_versions.push_back(name_versions[i]);
+            }
+        }
+        if (miss_index.empty()) {
+            return turbo::OkStatus();
+        }
+
+        std::vector<EA::discovery::ConfigInfo> miss_configs;
+        auto rs = DiscoveryClient::get_instance()->get_configs(miss_name_versions, miss_configs);
+        if (!rs.ok()) {
+            return rs;
+        }
+        for (size_t i = 0; i < miss_index.size(); ++i) {
+            rs = ConfigCache::get_instance()->add_config(miss_configs[i]);
+            if (!rs.ok() && !turbo::IsAlreadyExists(rs)) {
+                TLOG_WARN("add config to cache fail:{}", rs.message());
+            }
+            configs[miss_index[i]] = std::move(miss_configs[i]);
+        }
+        return turbo::OkStatus();
+    }
+
     turbo::Status ConfigClient::watch_config(const std::string &config_name, const ConfigEventListener &listener) {
         turbo::ModuleVersion module_version;
         std::unique_lock lock(_watch_mutex);
@@ -118,7 +173,7 @@ namespace EA::client {
         if (ait != _apply_version.end()) {
             module_version = ait->second;
         }
-        _watches[config_name] = ConfigWatchEntity{module_version, listener};
+        _watches[config_name] = ConfigWatchEntity{module_version, listener, std::make_shared<EA::ExecutionQueue>()};
         return turbo::OkStatus();
     }
 
@@ -128,10 +183,13 @@ namespace EA::client {
     }
 
     turbo::Status ConfigClient::do_unwatch_config(const std::string &config_name) {
-        if (_watches.find(config_name) == _watches.end()) {
+        auto it = _watches.find(config_name);
+        if (it == _watches.end()) {
             return turbo::NotFoundError("");
         }
-        _watches.erase(config_name);
+        /// the queued callbacks still run
+        it->second.notify_queue->stop();
+        _watches.erase(it);
         return turbo::OkStatus();
     }
 
@@ -184,55 +242,36 @@ namespace EA::client {
     }
 
     void ConfigClient::period_check() {
-        static turbo::ModuleVersion kZero;
         std::vector<std::pair<std::string, turbo::ModuleVersion>> updates;
-        turbo::flat_hash_map<std::string, ConfigWatchEntity> watches;
-        int sleep_step_us = FLAGS_config_watch_interval_ms * 1000;
+        WatchVersions watches;
         int sleep_round = FLAGS_config_watch_interval_round_s * 1000 * 1000;
+        int stalled_rounds = 0;
         TLOG_INFO("start config watch background");
         while(!_shutdown) {
             updates.clear();
             watches.clear();
             {
                 std::unique_lock lock(_watch_mutex);
-                watches = _watches;
+                for(auto &it : _watches) {
+                    watches[it.first] = it.second.notice_version;
+                }
             }
             TLOG_INFO("new round watch size:{}", watches.size());
-            for(auto &it : watches) {
-                EA::discovery::ConfigInfo info;
-                turbo::ModuleVersion current_version = it.second.notice_version;
-                auto rs = DiscoveryClient::get_instance()->get_config_latest(it.first, info);
-                if(!rs.ok()) {
-                    TLOG_WARN_IF(kZero != it.second.notice_version, "get config fail:{}", rs.message());
-                    continue;
-                }
-                TLOG_INFO("get config {} version:{}.{}.{}",info.name(),info.version().major(), info.version().minor(), info.version().patch());
-                rs = ConfigCache::get_instance()->add_config(info);
-                if(!rs.ok() && !turbo::IsAlreadyExists(rs)) {
-                    TLOG_WARN("add config to cache fail:{}", rs.message());
+            bool pushed = false;
+            size_t changed = 0;
+            if(FLAGS_config_watch_push && !watches.empty()) {
+                auto rs = push_check(watches, updates, &changed);
+                if(rs.ok()) {
+                    pushed = true;
+                } else {
+                    TLOG_WARN("watch config fail:{}, fall back to polling", rs.message());
                 }
-                turbo::ModuleVersion new_view(info.version().major(), info.version().minor(), info.version().patch());
-                if(current_version == kZero) {
-                    if(it.second.listener.on_new_config) {
-                        TLOG_INFO("call new config callback:{}",info.name());
-                        ConfigCallbackData data{info.name(), kZero,new_view,info.content(), config_type_to_string(info.type())};
-                        it.second.listener.on_new_config(data);
-                    } else {
-                        TLOG_INFO("call new config callback:{} but no call backer",info.name());
-                    }
-                } else if(current_version < new_view) {
-                    if(it.second.listener.on_new_version) {
-                        TLOG_INFO("call new config version, callback:{}",info.name());
-                        ConfigCallbackData data{info.name(), kZero,new_view, info.content(), config_type_to_string(info.type())};
-                        it.second.listener.on_new_version(data);
-                    } else {
-                        TLOG_INFO("call new config callback:{} but no call backer",info.name());
-                    }
-                }
-                updates.emplace_back(info.name(), new_view);
-                bthread_usleep(sleep_step_us);
+            }
+            if(!pushed) {
+                poll_check(watches, updates);
             }
 
+            bool progressed = false;
             {
                 std::unique_lock lock(_watch_mutex);
                 for(auto &item : updates) {
@@ -240,13 +279,148 @@ namespace EA::client {
                     if(it == _watches.end()) {
                         continue;
                     }
+                    progressed |= it->second.notice_version < item.second;
                     it->second.notice_version = item.second;
                 }
             }
-            bthread_usleep(sleep_round);
-
+            if(!pushed) {
+                bthread_usleep(sleep_round);
+                continue;
+            }
+            /// the server holds the watch request, no need to sleep. but a change reported and not taken,
+            /// e.g. the fetch failed, makes the next watch return at once, it is retried with backoff
+            if(changed > 0 && !progressed) {
+                int64_t backoff_us = (std::max(FLAGS_discovery_retry_backoff_base_ms, 1) * 1000LL)
+                                     << std::min(stalled_rounds, 20);
+                ++stalled_rounds;
+                bthread_usleep(std::min<int64_t>(backoff_us, sleep_round));
+            } else {
+                stalled_rounds = 0;
+            }
         }
         TLOG_INFO("config watch background stop...");
     }
-}  // namespace EA::client
 
+    turbo::Status ConfigClient::push_check(const WatchVersions &watches,
+                                           std::vector<std::pair<std::string, turbo::ModuleVersion>> &updates,
+                                           size_t *changed) {
+        std::vector<EA::discovery::ConfigInfo> changes;
+        auto rs = DiscoveryClient::get_instance()->watch_config(watches, changes);
+        if(!rs.ok()) {
+            return rs;
+        }
+        *changed = changes.size();
+        std::mutex update_mutex;
+        ConcurrencyBthread fetchers(FLAGS_config_watch_concurrency);
+        for(auto &change : changes) {
+            auto wit = watches.find(change.name());
+            if(wit == watches.end()) {
+                continue;
+            }
+            std::string name = change.name();
+            std::string version = version_to_string(change.version());
+            turbo::ModuleVersion notice_version = wit->second;
+            fetchers.run([this, name, version, notice_version, &updates, &update_mutex]() {
+                EA::discovery::ConfigInfo info;
+                auto rs = DiscoveryClient::get_instance()->get_config(name, version, info);
+                if(!rs.ok()) {
+                    TLOG_WARN("get config {} fail:{}", name, rs.message());
+                    return;
+                }
+                auto new_version = update_config(notice_version, info);
+                std::unique_lock lock(update_mutex);
+                updates.emplace_back(name, new_version);
+            });
+        }
+        fetchers.join();
+        return turbo::OkStatus();
+    }
+
+    void ConfigClient::poll_check(const WatchVersions &watches,
+                                  std::vector<std::pair<std::string, turbo::ModuleVersion>> &updates) {
+        static turbo::ModuleVersion kZero;
+        int sleep_step_us = FLAGS_config_watch_interval_ms * 1000;
+        std::mutex update_mutex;
+        ConcurrencyBthread fetchers(FLAGS_config_watch_concurrency);
+        for(auto &it : watches) {
+            std::string name = it.first;
+            turbo::ModuleVersion notice_version = it.second;
+            fetchers.run([this, name, notice_version, sleep_step_us, &updates, &update_mutex]() {
+                EA::discovery::ConfigInfo info;
+                bool modified = true;
+                turbo::Status rs;
+                if(notice_version == kZero) {
+                    rs = DiscoveryClient::get_instance()->get_config_latest(name, info);
+                } else {
+                    rs = DiscoveryClient::get_instance()->get_config_if_modified(name, notice_version, info, modified);
+                }
+                if(rs.ok() && modified) {
+                    auto new_version = update_config(notice_version, info);
+                    std::unique_lock lock(update_mutex);
+                    updates.emplace_back(name, new_version);
+                } else if(!rs.ok()) {
+                    TLOG_WARN_IF(kZero != notice_version, "get config fail:{}", rs.message());
+                }
+                /// each fetcher spaces its requests, bounds the request rate with the concurrency
+                bthread_usleep(sleep_step_us);
+            });
+        }
+        fetchers.join();
+    }
+
+    turbo::ModuleVersion ConfigClient::update_config(const turbo::ModuleVersion &notice_version,
+                                                     const EA::discovery::ConfigInfo &info) {
+        TLOG_INFO("get config {} version:{}.{}.{}",info.name(),info.version().major(), info.version().minor(), info.version().patch());
+        auto rs = ConfigCache::get_instance()->add_config(info);
+        if(!rs.ok() && !turbo::IsAlreadyExists(rs)) {
+            TLOG_WARN("add config to cache fail:{}", rs.message());
+        }
+        return notify_config(notice_version, info);
+    }
+
+    turbo::ModuleVersion ConfigClient::notify_config(const turbo::ModuleVersion &current_version,
+                                                     const EA::discovery::ConfigInfo &info) {
+        static turbo::ModuleVersion kZero;
+        turbo::ModuleVersion new_view(info.version().major(), info.version().minor(), info.version().patch());
+        if(current_version != kZero && !(current_version < new_view)) {
+            return new_view;
+        }
+        std::string content;
+        auto rs = get_config_content(info, content);
+        if(!rs.ok()) {
+            TLOG_WARN("get config {} content fail:{}", info.name(), rs.message());
+            return current_version;
+        }
+        ConfigEventListener listener;
+        std::shared_ptr<EA::ExecutionQueue> notify_queue;
+        {
+            std::unique_lock lock(_watch_mutex);
+            auto it = _watches.find(info.name());
+            if(it == _watches.end()) {
+                return new_view;
+            }
+            listener = it->second.listener;
+            notify_queue = it->second.notify_queue;
+        }
+        ConfigCallbackData data{info.name(), current_version, new_view, content, config_type_to_string(info.type())};
+        bool new_config = current_version == kZero;
+        notify_queue->run([listener, data, new_config]() {
+            if(new_config) {
+                if(listener.on_new_config) {
+                    TLOG_INFO("call new config callback:{}", data.config_name);
+                    listener.on_new_config(data);
+                } else {
+                    TLOG_INFO("call new config callback:{} but no call backer", data.config_name);
+                }
+            } else {
+                if(listener.on_new_version) {
+                    TLOG_INFO("call new config version, callback:{}", data.config_name);
+                    listener.on_new_version(data);
+                } else {
+                    TLOG_INFO("call new config callback:{} but no call backer", data.config_name);
+                }
+            }
+        });
+        return new_view;
+    }
+}  // namespace EA::client
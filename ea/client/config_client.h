@@ -28,6 +28,7 @@
 #include "ea/client/base_message_sender.h"
 #include "ea/client/discovery.h"
 #include "ea/base/bthread.h"
+#include "ea/base/double_buffer.h"
 
 namespace EA::client {
 
@@ -63,6 +64,8 @@ namespace EA::client {
     struct ConfigWatchEntity {
         turbo::ModuleVersion notice_version;
         ConfigEventListener listener;
+        /// the callbacks of the config run in order on it, different configs run in parallel
+        std::shared_ptr<EA::ExecutionQueue> notify_queue;
     };
 
     /**
@@ -119,6 +122,17 @@ namespace EA::client {
         turbo::Status get_config(const std::string &config_name, std::string &content, std::string *version = nullptr,
                                  std::string *type = nullptr);
 
+        /**
+         * @brief get_configs is used to get a batch of configs, the ones not in the ConfigCache are got from the
+         *        meta server in one request and added to the ConfigCache.
+         * @param name_versions [input] is the name and version of the configs to get, empty version for the latest.
+         * @param configs [out] is the configs got, in the order of name_versions. the content may be compressed,
+         *        read it by get_config_content.
+         * @return Status::OK if all the configs were got successfully. Otherwise, an error status is returned.
+         */
+        turbo::Status get_configs(const std::vector<std::pair<std::string, std::string>> &name_versions,
+                                  std::vector<EA::discovery::ConfigInfo> &configs);
+
         /**
          * @brief watch_config is used to watch a config. When the config is updated, the callback function will be called.
          * @param config_name [input] is the name of the config to watch. it can not be empty.
@@ -177,6 +191,45 @@ namespace EA::client {
         ///
         void period_check();
 
+        typedef turbo::flat_hash_map<std::string, turbo::ModuleVersion> WatchVersions;
+
+        /**
+         * @brief push_check hold one watch request for all the watched configs, fetch the content of
+         *        the changed ones in parallel and notify the listeners.
+         * @param watches [input] the watched configs and the versions noticed
+         * @param updates [output] the config versions noticed
+         * @param changed [output] the number of the configs the server reported changed
+         * @return Status::OK if the watch request returned, changed or not.
+         */
+        turbo::Status push_check(const WatchVersions &watches,
+                                 std::vector<std::pair<std::string, turbo::ModuleVersion>> &updates,
+                                 size_t *changed);
+
+        /**
+         * @brief poll_check get the latest version of the watched configs in parallel, at most
+         *        FLAGS_config_watch_concurrency at a time, and notify the listeners.
+         * @param watches [input] the watched configs and the versions noticed
+         * @param updates [output] the config versions noticed
+         */
+        void poll_check(const WatchVersions &watches,
+                        std::vector<std::pair<std::string, turbo::ModuleVersion>> &updates);
+
+        /**
+         * @brief update_config put the fetched config in the cache and notify the listeners.
+         * @param notice_version [input] the version noticed before
+         * @param info [input] the config fetched
+         * @return the version of info
+         */
+        turbo::ModuleVersion update_config(const turbo::ModuleVersion &notice_version, const EA::discovery::ConfigInfo &info);
+
+        /**
+         * @brief notify_config queue the callback of the listener of the config, if the config is newer.
+         * @param current_version [input] the version noticed before
+         * @param info [input] the config fetched
+         * @return the version of info
+         */
+        turbo::ModuleVersion notify_config(const turbo::ModuleVersion &current_version, const EA::discovery::ConfigInfo &info);
+
         /**
          *
          * @param config_name
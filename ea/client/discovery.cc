@@ -20,11 +20,14 @@
 #include "ea/client/config_info_builder.h"
 #include "ea/client/loader.h"
 #include "ea/client/dumper.h"
+#include "ea/client/naming_service.h"
 
 namespace EA::client {
 
     turbo::Status DiscoveryClient::init(BaseMessageSender *sender) {
         _sender = sender;
+        /// "ea://namespace/zone/servlet" channels resolve by this client
+        DiscoveryNamingService::register_naming_service();
         return turbo::OkStatus();
     }
 
@@ -175,6 +178,7 @@ namespace EA::client {
         EA::discovery::DiscoveryQueryResponse response;
         request.set_op_type(EA::discovery::QUERY_LIST_CONFIG_VERSION);
         request.set_config_name(config_name);
+        request.set_skip_content(true);
         auto rs = discovery_query(request, response, retry_time);
         if (!rs.ok()) {
             return rs;
@@ -196,6 +200,7 @@ namespace EA::client {
         EA::discovery::DiscoveryQueryResponse response;
         request.set_op_type(EA::discovery::QUERY_LIST_CONFIG_VERSION);
         request.set_config_name(config_name);
+        request.set_skip_content(true);
         auto rs = discovery_query(request, response, retry_time);
         if (!rs.ok()) {
             return rs;
@@ -237,6 +242,43 @@ namespace EA::client {
         return turbo::OkStatus();
     }
 
+    turbo::Status
+    DiscoveryClient::get_configs(const std::vector<std::pair<std::string, std::string>> &name_versions,
+                                 std::vector<EA::discovery::ConfigInfo> &configs, int *retry_time) {
+        EA::discovery::DiscoveryQueryRequest request;
+        EA::discovery::DiscoveryQueryResponse response;
+        request.set_op_type(EA::discovery::QUERY_MULTI_GET_CONFIG);
+        request.mutable_config_infos()->Reserve(name_versions.size());
+        for (auto &item : name_versions) {
+            auto info = request.add_config_infos();
+            info->set_name(item.first);
+            if (item.second.empty()) {
+                continue;
+            }
+            auto rs = string_to_version(item.second, info->mutable_version());
+            if (!rs.ok()) {
+                return rs;
+            }
+        }
+        auto rs = discovery_query(request, response, retry_time);
+        if (!rs.ok()) {
+            return rs;
+        }
+        if (response.errcode() != EA::discovery::SUCCESS) {
+            return turbo::UnknownError(response.errmsg());
+        }
+        if (static_cast<size_t>(response.config_infos_size()) != name_versions.size()) {
+            return turbo::InvalidArgumentError("bad proto for config list size {} not {}", response.config_infos_size(),
+                                               name_versions.size());
+        }
+        configs.clear();
+        configs.reserve(response.config_infos_size());
+        for (auto &info : response.config_infos()) {
+            configs.push_back(info);
+        }
+        return turbo::OkStatus();
+    }
+
     turbo::Status
     DiscoveryClient::get_config(const std::string &config_name, const std::string &version, std::string &config,
                            int *retry_time, std::string *type, uint32_t *time) {
@@ -245,7 +287,10 @@ namespace EA::client {
         if (!rs.ok()) {
             return rs;
         }
-        config = config_pb.content();
+        rs = get_config_content(config_pb, config);
+        if (!rs.ok()) {
+            return rs;
+        }
         if (type) {
             *type = config_type_to_string(config_pb.type());
         }
@@ -327,7 +372,10 @@ namespace EA::client {
         if (!rs.ok()) {
             return rs;
         }
-        config = config_pb.content();
+        rs = get_config_content(config_pb, config);
+        if (!rs.ok()) {
+            return rs;
+        }
         version = version_to_string(config_pb.version());
         return turbo::OkStatus();
     }
@@ -341,7 +389,10 @@ namespace EA::client {
         if (!rs.ok()) {
             return rs;
         }
-        config = config_pb.content();
+        rs = get_config_content(config_pb, config);
+        if (!rs.ok()) {
+            return rs;
+        }
         version = version_to_string(config_pb.version());
         type = config_type_to_string(config_pb.type());
         return turbo::OkStatus();
@@ -355,7 +406,10 @@ namespace EA::client {
         if (!rs.ok()) {
             return rs;
         }
-        config = config_pb.content();
+        rs = get_config_content(config_pb, config);
+        if (!rs.ok()) {
+            return rs;
+        }
         version = turbo::ModuleVersion(config_pb.version().major(), config_pb.version().minor(),
                                        config_pb.version().patch());
         return turbo::OkStatus();
@@ -370,7 +424,10 @@ namespace EA::client {
         if (!rs.ok()) {
             return rs;
         }
-        config = config_pb.content();
+        rs = get_config_content(config_pb, config);
+        if (!rs.ok()) {
+            return rs;
+        }
         version = turbo::ModuleVersion(config_pb.version().major(), config_pb.version().minor(),
                                        config_pb.version().patch());
         type = config_type_to_string(config_pb.type());
@@ -384,7 +441,65 @@ namespace EA::client {
         if (!rs.ok()) {
             return rs;
         }
-        config = config_pb.content();
+        rs = get_config_content(config_pb, config);
+        if (!rs.ok()) {
+            return rs;
+        }
+        return turbo::OkStatus();
+    }
+
+    turbo::Status
+    DiscoveryClient::get_config_if_modified(const std::string &config_name, const turbo::ModuleVersion &known_version,
+                                            EA::discovery::ConfigInfo &config, bool &modified, int *retry_time) {
+        EA::discovery::DiscoveryQueryRequest request;
+        EA::discovery::DiscoveryQueryResponse response;
+        request.set_op_type(EA::discovery::QUERY_GET_CONFIG);
+        request.set_config_name(config_name);
+        request.mutable_known_version()->set_major(known_version.major);
+        request.mutable_known_version()->set_minor(known_version.minor);
+        request.mutable_known_version()->set_patch(known_version.patch);
+        auto rs = discovery_query(request, response, retry_time);
+        if (!rs.ok()) {
+            return rs;
+        }
+        if (response.errcode() != EA::discovery::SUCCESS) {
+            return turbo::UnknownError(response.errmsg());
+        }
+        if (response.config_infos_size() != 1) {
+            return turbo::InvalidArgumentError("bad proto for config list size not 1");
+        }
+        config = response.config_infos(0);
+        turbo::ModuleVersion version(config.version().major(), config.version().minor(), config.version().patch());
+        modified = known_version < version;
+        return turbo::OkStatus();
+    }
+
+    turbo::Status
+    DiscoveryClient::watch_config(const turbo::flat_hash_map<std::string, turbo::ModuleVersion> &watches,
+                                  std::vector<EA::discovery::ConfigInfo> &changes, int *retry_time) {
+        EA::discovery::DiscoveryQueryRequest request;
+        EA::discovery::DiscoveryQueryResponse response;
+        request.set_op_type(EA::discovery::QUERY_WATCH_CONFIG);
+        request.mutable_config_infos()->Reserve(watches.size());
+        for (auto &it : watches) {
+            auto info = request.add_config_infos();
+            info->set_name(it.first);
+            info->mutable_version()->set_major(it.second.major);
+            info->mutable_version()->set_minor(it.second.minor);
+            info->mutable_version()->set_patch(it.second.patch);
+        }
+        auto rs = discovery_query(request, response, retry_time);
+        if (!rs.ok()) {
+            return rs;
+        }
+        if (response.errcode() != EA::discovery::SUCCESS) {
+            return turbo::UnknownError(response.errmsg());
+        }
+        changes.clear();
+        changes.reserve(response.config_infos_size());
+        for (auto &info : response.config_infos()) {
+            changes.push_back(info);
+        }
         return turbo::OkStatus();
     }
 
@@ -1338,5 +1453,26 @@ namespace EA::client {
 
     }
 
-}  // namespace EA::client
+    turbo::Status
+    DiscoveryClient::watch_instance(const std::string &ns_name, const std::string &zone_name,
+                                    const std::string &servlet, int64_t &last_updated_index,
+                                    EA::discovery::DiscoveryQueryResponse &response,
+                                    int *retry_time) {
+        EA::discovery::DiscoveryQueryRequest request;
+        request.set_op_type(EA::discovery::QUERY_INSTANCE_WATCH);
+        request.set_namespace_name(ns_name);
+        request.set_zone(zone_name);
+        request.set_servlet(servlet);
+        request.set_last_updated_index(last_updated_index);
+        auto rs = discovery_query(request, response, retry_time);
+        if (!rs.ok()) {
+            return rs;
+        }
+        if (response.errcode() != EA::discovery::SUCCESS) {
+            return turbo::UnknownError(response.errmsg());
+        }
+        last_updated_index = response.last_updated_index();
+        return turbo::OkStatus();
+    }
 
+}  // namespace EA::client
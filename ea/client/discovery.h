@@ -27,6 +27,7 @@
 #include <google/protobuf/descriptor.h>
 #include "eapi/discovery/discovery.interface.pb.h"
 #include "turbo/module/module_version.h"
+#include "turbo/container/flat_hash_map.h"
 #include "ea/client/base_message_sender.h"
 
 
@@ -189,6 +190,17 @@ namespace EA::client {
         get_config(const std::string &config_name, const std::string &version, EA::discovery::ConfigInfo &config,
                    int *retry_time = nullptr);
 
+        /**
+         * @brief get_configs is used to get a batch of configs from the meta server in one request, it is a synchronous call.
+         * @param name_versions [input] is the name and version of the configs to get, empty version for the latest.
+         * @param configs [output] is the configs received from the meta server, in the order of name_versions.
+         * @param retry_time [input] is the retry times of the get configs.
+         * @return Status::OK if all the configs were received successfully. Otherwise, an error status is returned.
+         */
+        turbo::Status
+        get_configs(const std::vector<std::pair<std::string, std::string>> &name_versions,
+                    std::vector<EA::discovery::ConfigInfo> &configs, int *retry_time = nullptr);
+
         /**
          * @brief get_config is used to get a config from the meta server, it is a synchronous call.
          * @param config_name [input] is the name of the config to get.
@@ -296,6 +308,34 @@ namespace EA::client {
         turbo::Status
         get_config_latest(const std::string &config_name, std::string &config, int *retry_time = nullptr);
 
+        /**
+         * @brief get_config_if_modified is used to get the latest version of a config from the meta server only if it is
+         *        newer than the version the caller already has, it is a synchronous call.
+         * @param config_name [input] is the name of the config to get.
+         * @param known_version [input] is the version the caller already has.
+         * @param config [output] is the latest config, without content when not modified.
+         * @param modified [output] is true if the latest version is newer than known_version.
+         * @param retry_time [input] is the retry times of the get config.
+         * @return Status::OK if the config was received successfully. Otherwise, an error status is returned.
+         */
+        turbo::Status
+        get_config_if_modified(const std::string &config_name, const turbo::ModuleVersion &known_version,
+                               EA::discovery::ConfigInfo &config, bool &modified, int *retry_time = nullptr);
+
+        /**
+         * @brief watch_config is used to wait for new versions of a set of configs from the meta server, it is a synchronous call.
+         *        the server holds the request until one of the configs has a version newer than the one given in watches,
+         *        or the watch timeout passed. only name, version and type of the changed configs are returned, fetch the
+         *        content with get_config.
+         * @param watches [input] config name --> the version already known by the caller, zero version for none.
+         * @param changes [output] configs that have a newer version, empty if the watch timeout passed.
+         * @param retry_time [input] is the retry times of the watch config.
+         * @return Status::OK if the watch returned successfully. Otherwise, an error status is returned.
+         */
+        turbo::Status
+        watch_config(const turbo::flat_hash_map<std::string, turbo::ModuleVersion> &watches,
+                     std::vector<EA::discovery::ConfigInfo> &changes, int *retry_time = nullptr);
+
         /**
          * @brief remove_config is used to remove a config from the meta server, it is a synchronous call.
          * @param config_name [input] is the name of the config to get the latest version for.
@@ -861,6 +901,25 @@ namespace EA::client {
                           const std::string &json_path,
                           int *retry_time = nullptr);
 
+        /**
+         * @brief watch_instance is used to wait for instance changes of a namespace/zone/servlet from the meta server,
+         *        it is a synchronous call, the server holds the request until a change after last_updated_index is
+         *        applied or the watch timeout passed. empty ns/zone/servlet match all.
+         * @param ns_name [input] is the namespace name of the instances to watch.
+         * @param zone_name [input] is the zone name of the instances to watch.
+         * @param servlet [input] is the servlet name of the instances to watch.
+         * @param last_updated_index [input/output] is the index returned by the previous watch, 0 for the first call.
+         *        it is advanced to the index the returned changes are up to.
+         * @param response [output] carries added_instances/updated_instances/removed_instances, or the whole instance
+         *        set in flatten_instances when is_full_update is set.
+         * @param retry_time [input] is the retry times of the watch.
+         * @return Status::OK if the changes were received successfully. Otherwise, an error status is returned.
+         */
+        turbo::Status watch_instance(const std::string &ns_name, const std::string &zone_name,
+                                     const std::string &servlet, int64_t &last_updated_index,
+                                     EA::discovery::DiscoveryQueryResponse &response,
+                                     int *retry_time = nullptr);
+
         /**
          * @brief discovery_manager is used to send a DiscoveryManagerRequest to the meta server.
          * @param request [input] is the DiscoveryManagerRequest to send.
@@ -881,6 +940,46 @@ namespace EA::client {
         turbo::Status discovery_query(const EA::discovery::DiscoveryQueryRequest &request,
                                  EA::discovery::DiscoveryQueryResponse &response, int *retry_time);
 
+        /**
+         * @brief async_discovery_manager is used to send a DiscoveryManagerRequest to the meta server asynchronously.
+         *        It returns at once, callback is called when the request is finished, retries and leader redirects
+         *        included. Many requests can be in flight from one thread at the same time.
+         * @param request [input] is the DiscoveryManagerRequest to send, it must be valid until callback is called.
+         * @param response [output] is the MetaManagerResponse received from the meta server, it must be valid until
+         *        callback is called.
+         * @param callback [input] is called with the status of the request, check response.errcode() if it is ok.
+         * @param retry_time [input] is the retry times of the meta manager.
+         */
+        void async_discovery_manager(const EA::discovery::DiscoveryManagerRequest *request,
+                                     EA::discovery::DiscoveryManagerResponse *response,
+                                     const SenderCallback &callback, int *retry_time = nullptr);
+
+        /**
+         * @brief async_discovery_query is used to send a DiscoveryQueryRequest to the meta server asynchronously.
+         *        It returns at once, callback is called when the request is finished, retries and leader redirects
+         *        included. Many requests can be in flight from one thread at the same time.
+         * @code
+         *      auto request = std::make_shared<EA::discovery::DiscoveryQueryRequest>();
+         *      auto response = std::make_shared<EA::discovery::DiscoveryQueryResponse>();
+         *      request->set_op_type(EA::discovery::QUERY_LIST_CONFIG);
+         *      DiscoveryClient::get_instance()->async_discovery_query(request.get(), response.get(),
+         *          [request, response](const turbo::Status &status) {
+         *              if (!status.ok() || response->errcode() != EA::discovery::SUCCESS) {
+         *                  return;
+         *              }
+         *              // use response
+         *          });
+         * @endcode
+         * @param request [input] is the DiscoveryQueryRequest to send, it must be valid until callback is called.
+         * @param response [output] is the DiscoveryQueryResponse received from the meta server, it must be valid
+         *        until callback is called.
+         * @param callback [input] is called with the status of the request, check response.errcode() if it is ok.
+         * @param retry_time [input] is the retry times of the meta query.
+         */
+        void async_discovery_query(const EA::discovery::DiscoveryQueryRequest *request,
+                                   EA::discovery::DiscoveryQueryResponse *response,
+                                   const SenderCallback &callback, int *retry_time = nullptr);
+
     private:
         BaseMessageSender *_sender;
     };
@@ -901,6 +1000,26 @@ namespace EA::client {
         return _sender->discovery_query(request, response, *retry_time);
     }
 
+    inline void DiscoveryClient::async_discovery_manager(const EA::discovery::DiscoveryManagerRequest *request,
+                                                         EA::discovery::DiscoveryManagerResponse *response,
+                                                         const SenderCallback &callback, int *retry_time) {
+        if (!retry_time) {
+            _sender->async_discovery_manager(request, response, callback);
+            return;
+        }
+        _sender->async_discovery_manager(request, response, callback, *retry_time);
+    }
+
+    inline void DiscoveryClient::async_discovery_query(const EA::discovery::DiscoveryQueryRequest *request,
+                                                       EA::discovery::DiscoveryQueryResponse *response,
+                                                       const SenderCallback &callback, int *retry_time) {
+        if (!retry_time) {
+            _sender->async_discovery_query(request, response, callback);
+            return;
+        }
+        _sender->async_discovery_query(request, response, callback, *retry_time);
+    }
+
 }  // namespace EA::client
 
 #endif // EA_CLIENT_META_H_
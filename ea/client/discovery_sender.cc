@@ -15,15 +15,21 @@
 
 
 #include "ea/client/discovery_sender.h"
+#include <algorithm>
+#include <vector>
 #include <braft/route_table.h>
 #include <braft/raft.h>
 #include <braft/util.h>
+#include <braft/cli.pb.h>
+#include "turbo/strings/str_join.h"
+#include "ea/flags/discovery.h"
 
 namespace EA::client {
 
 
     turbo::Status DiscoverySender::init(const std::string & raft_nodes) {
         _master_leader_address.ip = butil::IP_ANY;
+        _channel_cache->set_timeout(_request_timeout, _connect_timeout);
         std::vector<std::string> peers = turbo::StrSplit(raft_nodes, turbo::ByAnyChar(",;\t\n "));
         for (auto &peer : peers) {
             butil::EndPoint end_point;
@@ -32,9 +38,28 @@ namespace EA::client {
             }
             _servlet_nodes.push_back(end_point);
         }
+        if (_meta_raft_group.empty()) {
+            _meta_raft_group = FLAGS_discovery_raft_group;
+        }
+        std::vector<std::string> nodes;
+        braft::Configuration conf;
+        for (auto &node : _servlet_nodes) {
+            conf.add_peer(braft::PeerId(node));
+            nodes.push_back(butil::endpoint2str(node).c_str());
+        }
+        std::sort(nodes.begin(), nodes.end());
+        _route_table_key = _meta_raft_group + "@" + turbo::StrJoin(nodes, ",");
+        if (braft::rtb::update_configuration(_route_table_key, conf) != 0) {
+            TLOG_WARN("update route table of group {} fail, leader is found by redirects only", _route_table_key);
+        }
         return turbo::OkStatus();
     }
 
+    DiscoverySender &DiscoverySender::set_raft_group(const std::string &group) {
+        _meta_raft_group = group;
+        return *this;
+    }
+
 
     std::string DiscoverySender::get_leader() const {
         TLOG_INFO_IF(_verbose, "get master address:{}", butil::endpoint2str(_master_leader_address).c_str());
@@ -43,10 +68,119 @@ namespace EA::client {
 
     void DiscoverySender::set_leader_address(const butil::EndPoint &addr) {
         std::unique_lock<std::mutex> lock(_master_leader_mutex);
+        if (_master_leader_address != addr && _master_leader_address.ip != butil::IP_ANY) {
+            /// leader changed, connections to the old one are not needed any more
+            _channel_cache->remove_channel(_master_leader_address);
+        }
         _master_leader_address = addr;
+        /// keep the route table in step, a cleared leader makes the next select refresh it
+        if (!_route_table_key.empty()) {
+            braft::rtb::update_leader(_route_table_key,
+                                      addr.ip == butil::IP_ANY ? braft::PeerId() : braft::PeerId(addr));
+        }
         TLOG_INFO_IF(_verbose, "set master address:{}", butil::endpoint2str(_master_leader_address).c_str());
     }
 
+    butil::EndPoint DiscoverySender::get_leader_address() {
+        std::unique_lock<std::mutex> lock(_master_leader_mutex);
+        return _master_leader_address;
+    }
+
+    butil::EndPoint DiscoverySender::route_table_leader(bool refresh) {
+        if (_route_table_key.empty()) {
+            return butil::EndPoint();
+        }
+        braft::PeerId leader;
+        if (braft::rtb::select_leader(_route_table_key, &leader) == 0) {
+            return leader.addr;
+        }
+        if (!refresh) {
+            return butil::EndPoint();
+        }
+        /// rtb::refresh_leader asks for the group named by the key, the name on the servers is asked here.
+        /// all the nodes are asked at the same time with a short timeout, a dead node costs one probe timeout
+        size_t n = _servlet_nodes.size();
+        std::vector<brpc::Controller> cntls(n);
+        std::vector<braft::GetLeaderResponse> responses(n);
+        std::vector<std::shared_ptr<brpc::Channel>> channels(n);
+        braft::GetLeaderRequest request;
+        request.set_group_id(_meta_raft_group);
+        for (size_t i = 0; i < n; ++i) {
+            channels[i] = _channel_cache->get_channel(_servlet_nodes[i]);
+            if (!channels[i]) {
+                continue;
+            }
+            cntls[i].set_timeout_ms(std::min(FLAGS_discovery_leader_probe_timeout_ms, _connect_timeout));
+            braft::CliService_Stub stub(channels[i].get());
+            stub.get_leader(&cntls[i], &request, &responses[i], brpc::DoNothing());
+        }
+        bool found = false;
+        for (size_t i = 0; i < n; ++i) {
+            if (!channels[i]) {
+                continue;
+            }
+            brpc::Join(cntls[i].call_id());
+            if (found) {
+                continue;
+            }
+            if (cntls[i].Failed() || leader.parse(responses[i].leader_id()) != 0) {
+                TLOG_WARN_IF(_verbose, "get leader of group {} from {} fail:{}", _meta_raft_group,
+                             butil::endpoint2str(_servlet_nodes[i]).c_str(), cntls[i].ErrorText());
+                continue;
+            }
+            found = true;
+        }
+        if (!found) {
+            return butil::EndPoint();
+        }
+        braft::rtb::update_leader(_route_table_key, leader);
+        TLOG_INFO_IF(_verbose, "leader of group {} from route table:{}", _route_table_key, leader.to_string());
+        return leader.addr;
+    }
+
+    int DiscoverySender::retry_backoff_ms(int retry_time) const {
+        if (_between_meta_connect_error_ms <= 0) {
+            return 0;
+        }
+        int64_t base_ms = std::max(FLAGS_discovery_retry_backoff_base_ms, 1);
+        int64_t backoff_ms = std::min<int64_t>(_between_meta_connect_error_ms, base_ms << std::min(retry_time, 20));
+        /// equal jitter, keeps half of the backoff and spreads the retries of the clients on the other half
+        return static_cast<int>(backoff_ms / 2 + butil::fast_rand_less_than(backoff_ms / 2 + 1));
+    }
+
+    std::shared_ptr<brpc::Channel> DiscoverySender::get_read_channel() {
+        if (FLAGS_discovery_read_lb.empty()) {
+            return nullptr;
+        }
+        std::unique_lock<std::mutex> lock(_read_mutex);
+        if (_read_channel) {
+            return _read_channel;
+        }
+        std::string url = "list://";
+        for (size_t i = 0; i < _servlet_nodes.size(); ++i) {
+            if (i != 0) {
+                url += ",";
+            }
+            url += butil::endpoint2str(_servlet_nodes[i]).c_str();
+        }
+        brpc::ChannelOptions channel_opt;
+        channel_opt.timeout_ms = _request_timeout;
+        channel_opt.connect_timeout_ms = _connect_timeout;
+        channel_opt.connection_type = FLAGS_discovery_connection_type;
+        auto channel = std::make_shared<brpc::Channel>();
+        if (channel->Init(url.c_str(), FLAGS_discovery_read_lb.c_str(), &channel_opt) != 0) {
+            TLOG_WARN("init read channel to {} fail, lb:{}", url, FLAGS_discovery_read_lb);
+            return nullptr;
+        }
+        _read_channel = channel;
+        return _read_channel;
+    }
+
+    bool DiscoverySender::can_hedge(const EA::discovery::DiscoveryQueryRequest &request) {
+        return request.op_type() != EA::discovery::QUERY_INSTANCE_WATCH &&
+               request.op_type() != EA::discovery::QUERY_WATCH_CONFIG;
+    }
+
     turbo::Status DiscoverySender::discovery_manager(const EA::discovery::DiscoveryManagerRequest &request,
                                            EA::discovery::DiscoveryManagerResponse &response, int retry_times) {
         return send_request("discovery_manager", request, response, retry_times);
@@ -67,6 +201,30 @@ namespace EA::client {
         return send_request("discovery_query", request, response, _retry_times);
     }
 
+    void DiscoverySender::async_discovery_manager(const EA::discovery::DiscoveryManagerRequest *request,
+                                                  EA::discovery::DiscoveryManagerResponse *response,
+                                                  const SenderCallback &callback, int retry_times) {
+        async_send_request("discovery_manager", request, response, callback, retry_times);
+    }
+
+    void DiscoverySender::async_discovery_manager(const EA::discovery::DiscoveryManagerRequest *request,
+                                                  EA::discovery::DiscoveryManagerResponse *response,
+                                                  const SenderCallback &callback) {
+        async_send_request("discovery_manager", request, response, callback, _retry_times);
+    }
+
+    void DiscoverySender::async_discovery_query(const EA::discovery::DiscoveryQueryRequest *request,
+                                                EA::discovery::DiscoveryQueryResponse *response,
+                                                const SenderCallback &callback, int retry_times) {
+        async_send_request("discovery_query", request, response, callback, retry_times);
+    }
+
+    void DiscoverySender::async_discovery_query(const EA::discovery::DiscoveryQueryRequest *request,
+                                                EA::discovery::DiscoveryQueryResponse *response,
+                                                const SenderCallback &callback) {
+        async_send_request("discovery_query", request, response, callback, _retry_times);
+    }
+
 
     DiscoverySender &DiscoverySender::set_verbose(bool verbose) {
         _verbose = verbose;
@@ -75,11 +233,17 @@ namespace EA::client {
 
     DiscoverySender &DiscoverySender::set_time_out(int time_ms) {
         _request_timeout = time_ms;
+        _channel_cache->set_timeout(_request_timeout, _connect_timeout);
+        std::unique_lock<std::mutex> lock(_read_mutex);
+        _read_channel.reset();
         return *this;
     }
 
     DiscoverySender &DiscoverySender::set_connect_time_out(int time_ms) {
         _connect_timeout = time_ms;
+        _channel_cache->set_timeout(_request_timeout, _connect_timeout);
+        std::unique_lock<std::mutex> lock(_read_mutex);
+        _read_channel.reset();
         return *this;
     }
 
@@ -93,5 +257,11 @@ namespace EA::client {
         return *this;
     }
 
+    DiscoverySender &DiscoverySender::set_channel_cache(const std::shared_ptr<ChannelCache> &cache) {
+        _channel_cache = cache;
+        _channel_cache->set_timeout(_request_timeout, _connect_timeout);
+        return *this;
+    }
+
 }  // EA::client
 
@@ -20,21 +20,78 @@
 #include <brpc/channel.h>
 #include <brpc/server.h>
 #include <brpc/controller.h>
+#include <bvar/latency_recorder.h>
+#include <butil/hash.h>
 #include <google/protobuf/descriptor.h>
 #include "eapi/discovery/discovery.interface.pb.h"
 #include "ea/base/tlog.h"
 #include "ea/client/base_message_sender.h"
+#include "ea/client/channel_cache.h"
+#include "ea/flags/client.h"
+#include <bthread/unstable.h>
 
 namespace EA::client {
 
+    class DiscoverySender;
+
+    /**
+     * @ingroup ea_rpc
+     * @brief DiscoveryAsyncCall is one asynchronous request of DiscoverySender. It issues the request with
+     *        brpc asynchronous CallMethod and runs itself as the done closure. Queries are tried on the read
+     *        channel first and fall back to the leader if it fails. Leader redirects are issued
+     *        again at once, failures are retried by a bthread timer after the backoff time instead of
+     *        sleeping, and the callback is called after success or the last try. It deletes itself then.
+     */
+    template<typename Request, typename Response>
+    class DiscoveryAsyncCall : public google::protobuf::Closure {
+    public:
+        DiscoveryAsyncCall(DiscoverySender *sender, const google::protobuf::MethodDescriptor *method,
+                           const Request *request, Response *response, const SenderCallback &callback,
+                           int retry_times);
+
+        ~DiscoveryAsyncCall() override = default;
+
+        void issue();
+
+        void Run() override;
+
+    private:
+        void retry_later(int delay_ms);
+
+        void finish(const turbo::Status &status);
+
+        static void on_timer(void *arg);
+
+        static void *run_issue(void *arg);
+
+    private:
+        DiscoverySender *_sender;
+        const google::protobuf::MethodDescriptor *_method;
+        const Request *_request;
+        Response *_response;
+        SenderCallback _callback;
+        int _retry_times;
+        int _retry_time{0};
+        uint64_t _log_id;
+        bool _read_any;
+        brpc::Controller _cntl;
+        butil::EndPoint _address;
+        std::shared_ptr<brpc::Channel> _channel;
+    };
+
     /**
      * @ingroup ea_rpc
      * @brief DiscoverySender is used to send messages to the meta server.
      *       It communicates with the meta server and sends messages to the meta server.
      *       It needs to be initialized before use. It need judge the leader of meta server.
-     *       If the leader is not found, it will retry to send the request to the meta server.
-     *       If the peer is not leader, it will redirect to the leader and retry to send the
-     *       request to the meta server.
+     *       If the leader is not known, it asks the raft group for the leader through the braft
+     *       route table before picking a random node. If the peer is not leader, it will redirect
+     *       to the leader and retry to send the request to the meta server. Failures are retried
+     *       with exponential backoff and jitter, bounded by the interval time.
+     *       Queries go to the leader. If FLAGS_discovery_read_lb is set they need no raft, they are
+     *       load balanced over all the nodes of the group and only fall back to the leader when that
+     *       fails, at the cost of read-your-writes. Writes always go to the leader. When FLAGS_discovery_hedge_read is set, a backup query is sent to
+     *       another node if there is no reply after the p95 latency.
      * @code
      *      DiscoverySender::get_instance()->init("127.0.0.1:8200");
      *      EA::discovery::DiscoveryManagerRequest request;
@@ -91,6 +148,14 @@ namespace EA::client {
          */
         turbo::Status init(const std::string &raft_nodes);
 
+        /**
+         * @brief set_raft_group is used to set the raft group name of the meta server, FLAGS_discovery_raft_group
+         *        if not set. It must be called before init.
+         * @param group [input] is the raft group name of the meta server.
+         * @return DiscoverySender itself.
+         */
+        DiscoverySender &set_raft_group(const std::string &group);
+
         /**
          * @brief init is used to initialize the DiscoverySender. It can be called any time.
          * @param verbose [input] is the verbose flag.
@@ -114,8 +179,9 @@ namespace EA::client {
         DiscoverySender &set_connect_time_out(int time_ms);
 
         /**
-         * @brief set_interval_time is used to set the interval time for retrying to send a request to the meta server.
-         * @param time_ms [input] is the interval time in milliseconds for retrying to send a request to the meta server.
+         * @brief set_interval_time is used to set the max interval time for retrying to send a request to the meta server,
+         *        the backoff starts from FLAGS_discovery_retry_backoff_base_ms and doubles on each retry up to it.
+         * @param time_ms [input] is the max interval time in milliseconds for retrying to send a request to the meta server.
          * @return DiscoverySender itself.
          */
         DiscoverySender &set_interval_time(int time_ms);
@@ -127,6 +193,13 @@ namespace EA::client {
          */
         DiscoverySender &set_retry_time(int retry);
 
+        /**
+         * @brief set_channel_cache is used to share the channels with other DiscoverySenders talking to the same servers.
+         * @param cache [input] is the channel cache to use, the timeouts of this sender are applied to it.
+         * @return DiscoverySender itself.
+         */
+        DiscoverySender &set_channel_cache(const std::shared_ptr<ChannelCache> &cache);
+
         /**
          * @brief get_leader is used to get the leader address of the meta server.
          * @return the leader address of the meta server.
@@ -172,6 +245,61 @@ namespace EA::client {
         turbo::Status discovery_query(const EA::discovery::DiscoveryQueryRequest &request,
                                  EA::discovery::DiscoveryQueryResponse &response) override;
 
+        /**
+         * @brief async_discovery_manager is the asynchronous version of discovery_manager.
+         * @param request [input] is the DiscoveryManagerRequest to send, valid until callback is called.
+         * @param response [output] is the MetaManagerResponse received from the meta server.
+         * @param callback [input] is called with the result of the request.
+         * @param retry_times [input] is the number of times to retry sending the request.
+         */
+        void async_discovery_manager(const EA::discovery::DiscoveryManagerRequest *request,
+                                     EA::discovery::DiscoveryManagerResponse *response,
+                                     const SenderCallback &callback, int retry_times) override;
+
+        /**
+         * @brief async_discovery_manager is the asynchronous version of discovery_manager.
+         * @param request [input] is the DiscoveryManagerRequest to send, valid until callback is called.
+         * @param response [output] is the MetaManagerResponse received from the meta server.
+         * @param callback [input] is called with the result of the request.
+         */
+        void async_discovery_manager(const EA::discovery::DiscoveryManagerRequest *request,
+                                     EA::discovery::DiscoveryManagerResponse *response,
+                                     const SenderCallback &callback) override;
+
+        /**
+         * @brief async_discovery_query is the asynchronous version of discovery_query.
+         * @param request [input] is the DiscoveryQueryRequest to send, valid until callback is called.
+         * @param response [output] is the DiscoveryQueryResponse received from the meta server.
+         * @param callback [input] is called with the result of the request.
+         * @param retry_times [input] is the number of times to retry sending the request.
+         */
+        void async_discovery_query(const EA::discovery::DiscoveryQueryRequest *request,
+                                   EA::discovery::DiscoveryQueryResponse *response,
+                                   const SenderCallback &callback, int retry_times) override;
+
+        /**
+         * @brief async_discovery_query is the asynchronous version of discovery_query.
+         * @param request [input] is the DiscoveryQueryRequest to send, valid until callback is called.
+         * @param response [output] is the DiscoveryQueryResponse received from the meta server.
+         * @param callback [input] is called with the result of the request.
+         */
+        void async_discovery_query(const EA::discovery::DiscoveryQueryRequest *request,
+                                   EA::discovery::DiscoveryQueryResponse *response,
+                                   const SenderCallback &callback) override;
+
+        /**
+         * @brief async_send_request is used to send a request to the meta server asynchronously.
+         * @param service_name [input] is the name of the service to send the request to.
+         * @param request [input] is the request to send, valid until callback is called.
+         * @param response [output] is the response received from the meta server.
+         * @param callback [input] is called with the result of the request.
+         * @param retry_times [input] is the number of times to retry sending the request.
+         */
+        template<typename Request, typename Response>
+        void async_send_request(const std::string &service_name,
+                                const Request *request,
+                                Response *response, const SenderCallback &callback, int retry_times);
+
         /**
          * @brief send_request is used to send a request to the meta server.
          * @param service_name [input] is the name of the service to send the request to.
@@ -186,6 +314,8 @@ namespace EA::client {
                                    Response &response, int retry_times);
 
     private:
+        template<typename Request, typename Response>
+        friend class DiscoveryAsyncCall;
 
         /**
          *
@@ -193,8 +323,77 @@ namespace EA::client {
          */
         void set_leader_address(const butil::EndPoint &addr);
 
+        /**
+         *
+         * @return the leader address, IP_ANY if not known
+         */
+        butil::EndPoint get_leader_address();
+
+        /**
+         * @brief route_table_leader is used to get the leader known by the braft route table, the entry of this
+         *        sender is keyed by the group name and the nodes, the senders of other clusters do not share it.
+         * @param refresh [input] ask the nodes of the group for the leader if the route table has none, it blocks
+         *        up to FLAGS_discovery_leader_probe_timeout_ms.
+         * @return the leader address, IP_ANY if not known
+         */
+        butil::EndPoint route_table_leader(bool refresh);
+
+        /**
+         * @brief retry_backoff_ms is used to get the time to wait before the retry, exponential with jitter.
+         * @param retry_time [input] is the number of tries done.
+         * @return the time to wait in milliseconds.
+         */
+        int retry_backoff_ms(int retry_time) const;
+
+        /**
+         * @brief read_request is used to send a query to any node by the read load balancer, with a backup
+         *        request to another node after the p95 latency of the queries if the query can be hedged.
+         */
+        template<typename Request, typename Response>
+        turbo::Status read_request(const google::protobuf::MethodDescriptor *method,
+                                   const Request &request, Response &response);
+
+        /**
+         * @brief prepare_read is used to set the request code and the backup request of a query sent
+         *        by the read channel.
+         * @return true if the query can be hedged.
+         */
+        template<typename Request>
+        bool prepare_read(const Request &request, brpc::Controller *cntl);
+
+        /**
+         * @brief get_read_channel is used to get the channel load balancing over all the nodes.
+         * @return the channel, or nullptr if the reads go to the leader only.
+         */
+        std::shared_ptr<brpc::Channel> get_read_channel();
+
+        /**
+         * @brief is_read is used to check if the request can be served by any node of the group.
+         */
+        template<typename Request>
+        static bool is_read(const Request &) {
+            return false;
+        }
+
+        static bool is_read(const EA::discovery::DiscoveryQueryRequest &) {
+            return true;
+        }
+
+        /**
+         * @brief can_hedge is used to check if the request is a short read that can be sent twice.
+         *        The watch queries are held by the server and are not hedged.
+         */
+        template<typename Request>
+        static bool can_hedge(const Request &) {
+            return false;
+        }
+
+        static bool can_hedge(const EA::discovery::DiscoveryQueryRequest &request);
+
     private:
         std::string _meta_raft_group;
+        /// the route table is process global, keyed by the group and the sorted nodes of the cluster
+        std::string _route_table_key;
         std::string _meta_nodes;
         std::vector<butil::EndPoint> _servlet_nodes;
         int32_t _request_timeout = 30000;
@@ -205,6 +404,10 @@ namespace EA::client {
         int _between_meta_connect_error_ms{1000};
         int _retry_times{kRetryTimes};
         bool _verbose{false};
+        std::shared_ptr<ChannelCache> _channel_cache{std::make_shared<ChannelCache>()};
+        std::mutex _read_mutex;
+        std::shared_ptr<brpc::Channel> _read_channel;
+        bvar::LatencyRecorder _query_latency;
     };
 
     template<typename Request, typename Response>
@@ -218,22 +421,38 @@ namespace EA::client {
             TLOG_ERROR_IF(_verbose, "service name not exist, service:{}", service_name);
             return turbo::UnavailableError("service name not exist, service:{}", service_name);
         }
+        bool hedge = can_hedge(request);
+        if (is_read(request) && _servlet_nodes.size() > 1) {
+            auto rs = read_request(method, request, response);
+            if (rs.ok()) {
+                return rs;
+            }
+            TLOG_WARN_IF(_verbose, "read request fail:{}, send to leader", rs.message());
+            response.Clear();
+        }
         int retry_time = 0;
         bool is_select_leader{false};
+        bool leader_refreshed{false};
         uint64_t log_id = butil::fast_rand();
         do {
-            if (!is_select_leader && retry_time > 0 && _between_meta_connect_error_ms > 0) {
-                bthread_usleep(1000 * _between_meta_connect_error_ms);
+            if (!is_select_leader && retry_time > 0) {
+                auto backoff_ms = retry_backoff_ms(retry_time);
+                if (backoff_ms > 0) {
+                    bthread_usleep(1000 * backoff_ms);
+                }
             }
             brpc::Controller cntl;
             cntl.set_log_id(log_id);
-            std::unique_lock<std::mutex> lck(_master_leader_mutex);
-            butil::EndPoint leader_address = _master_leader_address;
-            lck.unlock();
-            brpc::ChannelOptions channel_opt;
-            channel_opt.timeout_ms = _request_timeout;
-            channel_opt.connect_timeout_ms = _connect_timeout;
-            brpc::Channel short_channel;
+            if (call_timeout_ms(request) > _request_timeout) {
+                cntl.set_timeout_ms(call_timeout_ms(request));
+            }
+            butil::EndPoint leader_address = get_leader_address();
+            if (leader_address.ip == butil::IP_ANY) {
+                /// ask the group for the leader before guessing, once per request, the redirects of the
+                /// randomly selected nodes find it on the later tries
+                leader_address = route_table_leader(!leader_refreshed);
+                leader_refreshed = true;
+            }
             is_select_leader = leader_address.ip == butil::IP_ANY;
             //store has leader address
             if (is_select_leader) {
@@ -243,20 +462,22 @@ namespace EA::client {
             }
             TLOG_INFO_IF(_verbose & !is_select_leader, "master address:{}",
                          butil::endpoint2str(_master_leader_address).c_str());
-            if (short_channel.Init(leader_address, &channel_opt) != 0) {
+            auto channel = _channel_cache->get_channel(leader_address);
+            if (!channel) {
                 TLOG_ERROR_IF(_verbose, "connect with meta server fail. channel Init fail, leader_addr:{}",
                               butil::endpoint2str(leader_address).c_str());
                 set_leader_address(butil::EndPoint());
                 ++retry_time;
                 continue;
             }
-            short_channel.CallMethod(method, &cntl, &request, &response, nullptr);
+            channel->CallMethod(method, &cntl, &request, &response, nullptr);
 
             TLOG_INFO_IF(_verbose, "meta_req[{}], meta_resp[{}]", request.ShortDebugString(),
                          response.ShortDebugString());
             if (cntl.Failed()) {
                 TLOG_WARN_IF(_verbose, "connect with server fail. send request fail, error:{}, log_id:{}",
                              cntl.ErrorText(), cntl.log_id());
+                _channel_cache->remove_channel(leader_address);
                 set_leader_address(butil::EndPoint());
                 ++retry_time;
                 continue;
@@ -267,6 +488,15 @@ namespace EA::client {
                 ++retry_time;
                 continue;
             }
+            if (response.errcode() == EA::discovery::RETRY_LATER) {
+                /// the leader sheds load, keep it and back off
+                TLOG_WARN_IF(_verbose, "server:{} busy, retry later, log_id:{}",
+                             butil::endpoint2str(cntl.remote_side()).c_str(), cntl.log_id());
+                set_leader_address(leader_address);
+                is_select_leader = false;
+                ++retry_time;
+                continue;
+            }
             if (response.errcode() == EA::discovery::NOT_LEADER) {
                 TLOG_WARN_IF(_verbose, "connect with meta server:{} fail. not leader, redirect to :{}, log_id:{}",
                              butil::endpoint2str(cntl.remote_side()).c_str(),
@@ -284,10 +514,234 @@ namespace EA::client {
                             butil::endpoint2str(leader_address).c_str(),cntl.log_id());
                 set_leader_address(leader_address);
             }
+            if (hedge) {
+                _query_latency << cntl.latency_us();
+            }
             return turbo::OkStatus();
         } while (retry_time < retry_times);
         return turbo::UnavailableError("can not connect server after {} times try", retry_times);
     }
 
+    template<typename Request>
+    inline bool DiscoverySender::prepare_read(const Request &request, brpc::Controller *cntl) {
+        if (FLAGS_discovery_read_lb.compare(0, 2, "c_") == 0) {
+            /// same query to the same node, keeps the server side caches warm
+            std::string key = request.SerializeAsString();
+            cntl->set_request_code(butil::Hash(key));
+        }
+        if (!FLAGS_discovery_hedge_read || !can_hedge(request)) {
+            return false;
+        }
+        /// no sample yet gives 0, the min delay is used then
+        int64_t backup_ms = std::max<int64_t>(_query_latency.latency_percentile(0.95) / 1000,
+                                              FLAGS_discovery_hedge_read_min_ms);
+        if (backup_ms < _request_timeout) {
+            cntl->set_backup_request_ms(backup_ms);
+        }
+        return true;
+    }
+
+    template<typename Request, typename Response>
+    inline turbo::Status DiscoverySender::read_request(const google::protobuf::MethodDescriptor *method,
+                                                       const Request &request, Response &response) {
+        auto channel = get_read_channel();
+        if (!channel) {
+            return turbo::UnavailableError("read channel not ready");
+        }
+        brpc::Controller cntl;
+        cntl.set_log_id(butil::fast_rand());
+        if (call_timeout_ms(request) > _request_timeout) {
+            cntl.set_timeout_ms(call_timeout_ms(request));
+        }
+        prepare_read(request, &cntl);
+        channel->CallMethod(method, &cntl, &request, &response, nullptr);
+        if (cntl.Failed()) {
+            return turbo::UnavailableError("send request fail, error:{}, log_id:{}", cntl.ErrorText(), cntl.log_id());
+        }
+        if (response.errcode() == EA::discovery::HAVE_NOT_INIT) {
+            return turbo::UnavailableError("server:{} have not init, log_id:{}",
+                                           butil::endpoint2str(cntl.remote_side()).c_str(), cntl.log_id());
+        }
+        TLOG_INFO_IF(_verbose, "read req[{}] served by {}, has_backup:{}", request.ShortDebugString(),
+                     butil::endpoint2str(cntl.remote_side()).c_str(), cntl.has_backup_request());
+        if (can_hedge(request)) {
+            _query_latency << cntl.latency_us();
+        }
+        return turbo::OkStatus();
+    }
+
+
+    template<typename Request, typename Response>
+    inline void DiscoverySender::async_send_request(const std::string &service_name,
+                                                    const Request *request,
+                                                    Response *response, const SenderCallback &callback,
+                                                    int retry_times) {
+        const ::google::protobuf::ServiceDescriptor *service_desc = EA::discovery::DiscoveryService::descriptor();
+        const ::google::protobuf::MethodDescriptor *method =
+                service_desc->FindMethodByName(service_name);
+        if (method == nullptr) {
+            TLOG_ERROR_IF(_verbose, "service name not exist, service:{}", service_name);
+            callback(turbo::UnavailableError("service name not exist, service:{}", service_name));
+            return;
+        }
+        auto call = new DiscoveryAsyncCall<Request, Response>(this, method, request, response, callback, retry_times);
+        call->issue();
+    }
+
+    template<typename Request, typename Response>
+    inline DiscoveryAsyncCall<Request, Response>::DiscoveryAsyncCall(DiscoverySender *sender,
+                                                                     const google::protobuf::MethodDescriptor *method,
+                                                                     const Request *request, Response *response,
+                                                                     const SenderCallback &callback, int retry_times)
+            : _sender(sender), _method(method), _request(request), _response(response),
+              _callback(callback), _retry_times(retry_times), _log_id(butil::fast_rand()),
+              _read_any(DiscoverySender::is_read(*request)) {}
+
+    template<typename Request, typename Response>
+    inline void DiscoveryAsyncCall<Request, Response>::issue() {
+        _cntl.Reset();
+        _cntl.set_log_id(_log_id);
+        if (DiscoverySender::call_timeout_ms(*_request) > _sender->_request_timeout) {
+            _cntl.set_timeout_ms(DiscoverySender::call_timeout_ms(*_request));
+        }
+        if (_read_any && _sender->_servlet_nodes.size() > 1) {
+            _channel = _sender->get_read_channel();
+            if (_channel) {
+                _sender->prepare_read(*_request, &_cntl);
+                _channel->CallMethod(_method, &_cntl, _request, _response, this);
+                return;
+            }
+        }
+        _read_any = false;
+        _address = _sender->get_leader_address();
+        if (_address.ip == butil::IP_ANY) {
+            /// refreshing the route table blocks, only use what it knows
+            _address = _sender->route_table_leader(false);
+        }
+        bool is_select_leader = _address.ip == butil::IP_ANY;
+        if (is_select_leader) {
+            TLOG_INFO_IF(_sender->_verbose, "master address null, select leader first");
+            auto seed = butil::fast_rand() % _sender->_servlet_nodes.size();
+            _address = _sender->_servlet_nodes[seed];
+        }
+        _channel = _sender->_channel_cache->get_channel(_address);
+        if (!_channel) {
+            TLOG_ERROR_IF(_sender->_verbose, "connect with meta server fail. channel Init fail, leader_addr:{}",
+                          butil::endpoint2str(_address).c_str());
+            _sender->set_leader_address(butil::EndPoint());
+            ++_retry_time;
+            retry_later(_sender->retry_backoff_ms(_retry_time));
+            return;
+        }
+        _channel->CallMethod(_method, &_cntl, _request, _response, this);
+    }
+
+    template<typename Request, typename Response>
+    inline void DiscoveryAsyncCall<Request, Response>::Run() {
+        _channel.reset();
+        TLOG_INFO_IF(_sender->_verbose, "meta_req[{}], meta_resp[{}]", _request->ShortDebugString(),
+                     _response->ShortDebugString());
+        if (_read_any) {
+            _read_any = false;
+            if (!_cntl.Failed() && _response->errcode() != EA::discovery::HAVE_NOT_INIT) {
+                if (DiscoverySender::can_hedge(*_request)) {
+                    _sender->_query_latency << _cntl.latency_us();
+                }
+                finish(turbo::OkStatus());
+                return;
+            }
+            TLOG_WARN_IF(_sender->_verbose, "read request fail, send to leader, log_id:{}", _log_id);
+            _response->Clear();
+            retry_later(0);
+            return;
+        }
+        if (_cntl.Failed()) {
+            TLOG_WARN_IF(_sender->_verbose, "connect with server fail. send request fail, error:{}, log_id:{}",
+                         _cntl.ErrorText(), _cntl.log_id());
+            _sender->_channel_cache->remove_channel(_address);
+            _sender->set_leader_address(butil::EndPoint());
+            ++_retry_time;
+            retry_later(_sender->retry_backoff_ms(_retry_time));
+            return;
+        }
+        if (_response->errcode() == EA::discovery::HAVE_NOT_INIT) {
+            TLOG_WARN_IF(_sender->_verbose, "connect with server fail. HAVE_NOT_INIT  log_id:{}", _cntl.log_id());
+            _sender->set_leader_address(butil::EndPoint());
+            ++_retry_time;
+            retry_later(_sender->retry_backoff_ms(_retry_time));
+            return;
+        }
+        if (_response->errcode() == EA::discovery::RETRY_LATER) {
+            TLOG_WARN_IF(_sender->_verbose, "server:{} busy, retry later, log_id:{}",
+                         butil::endpoint2str(_cntl.remote_side()).c_str(), _cntl.log_id());
+            _sender->set_leader_address(_address);
+            ++_retry_time;
+            retry_later(_sender->retry_backoff_ms(_retry_time));
+            return;
+        }
+        if (_response->errcode() == EA::discovery::NOT_LEADER) {
+            TLOG_WARN_IF(_sender->_verbose, "connect with meta server:{} fail. not leader, redirect to :{}, log_id:{}",
+                         butil::endpoint2str(_cntl.remote_side()).c_str(),
+                         _response->leader(), _cntl.log_id());
+            butil::EndPoint leader_addr;
+            butil::str2endpoint(_response->leader().c_str(), &leader_addr);
+            _sender->set_leader_address(leader_addr);
+            ++_retry_time;
+            retry_later(0);
+            return;
+        }
+        /// success, The node being tried happens to be leader
+        if (_sender->get_leader_address().ip == butil::IP_ANY) {
+            TLOG_INFO_IF(_sender->_verbose, "set leader ip:{}, log_id:{}",
+                         butil::endpoint2str(_address).c_str(), _cntl.log_id());
+            _sender->set_leader_address(_address);
+        }
+        finish(turbo::OkStatus());
+    }
+
+    template<typename Request, typename Response>
+    inline void DiscoveryAsyncCall<Request, Response>::retry_later(int delay_ms) {
+        if (_retry_time >= _retry_times) {
+            finish(turbo::UnavailableError("can not connect server after {} times try", _retry_times));
+            return;
+        }
+        if (delay_ms <= 0) {
+            /// not in the done of the previous call
+            bthread_t tid;
+            if (bthread_start_background(&tid, nullptr, run_issue, this) != 0) {
+                run_issue(this);
+            }
+            return;
+        }
+        bthread_timer_t timer;
+        if (bthread_timer_add(&timer, butil::milliseconds_from_now(delay_ms), on_timer, this) != 0) {
+            TLOG_WARN_IF(_sender->_verbose, "add retry timer fail, retry at once, log_id:{}", _log_id);
+            on_timer(this);
+        }
+    }
+
+    template<typename Request, typename Response>
+    inline void DiscoveryAsyncCall<Request, Response>::on_timer(void *arg) {
+        /// the timer thread should not be blocked, issue in a bthread
+        bthread_t tid;
+        if (bthread_start_background(&tid, nullptr, run_issue, arg) != 0) {
+            run_issue(arg);
+        }
+    }
+
+    template<typename Request, typename Response>
+    inline void *DiscoveryAsyncCall<Request, Response>::run_issue(void *arg) {
+        static_cast<DiscoveryAsyncCall<Request, Response> *>(arg)->issue();
+        return nullptr;
+    }
+
+    template<typename Request, typename Response>
+    inline void DiscoveryAsyncCall<Request, Response>::finish(const turbo::Status &status) {
+        if (_callback) {
+            _callback(status);
+        }
+        delete this;
+    }
+
 
 }  // namespace EA::client
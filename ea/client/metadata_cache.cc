@@ -0,0 +1,213 @@
+// Copyright 2023 The Elastic Architecture Infrastructure Authors.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "ea/client/metadata_cache.h"
+#include <butil/time.h>
+#include "turbo/files/filesystem.h"
+#include "ea/client/discovery.h"
+#include "ea/flags/client.h"
+#include "ea/base/bthread.h"
+
+namespace EA::client {
+
+    static const char *kMetadataCacheFile = "metadata.cache";
+
+    turbo::Status MetadataCache::init() {
+        std::string cache_dir = EA::FLAGS_config_cache_dir;
+        if (cache_dir.empty()) {
+            return turbo::OkStatus();
+        }
+        std::error_code ec;
+        if (!turbo::filesystem::exists(cache_dir, ec)) {
+            if (ec) {
+                return turbo::UnknownError(ec.message());
+            }
+            turbo::filesystem::create_directories(cache_dir);
+        }
+        auto file_path = turbo::Format("{}/{}", cache_dir, kMetadataCacheFile);
+        auto rs = _cache_file.open(file_path, [this](std::string_view key, std::string_view value) {
+            auto response = std::make_shared<EA::discovery::DiscoveryQueryResponse>();
+            if (!response->ParseFromArray(value.data(), value.size())) {
+                TLOG_WARN("bad metadata cache record, size:{}", value.size());
+                return;
+            }
+            /// loaded as too old to serve without trying the server first
+            std::unique_lock lock(_cache_mutex);
+            auto &entry = _entries[std::string(key)];
+            entry.response = response;
+            entry.fetch_time_us = 0;
+            entry.version = 1;
+        });
+        if (!rs.ok()) {
+            return rs;
+        }
+        _persist = true;
+        return turbo::OkStatus();
+    }
+
+    turbo::Status MetadataCache::query(const EA::discovery::DiscoveryQueryRequest &request,
+                                       EA::discovery::DiscoveryQueryResponse &response, int64_t *version) {
+        if (request.op_type() == EA::discovery::QUERY_INSTANCE_WATCH ||
+            request.op_type() == EA::discovery::QUERY_WATCH_CONFIG) {
+            return turbo::InvalidArgumentError("watch query can not be cached");
+        }
+        auto key = make_key(request);
+        int64_t now = butil::gettimeofday_us();
+        bool served = false;
+        bool need_refresh = false;
+        {
+            std::unique_lock lock(_cache_mutex);
+            auto it = _entries.find(key);
+            if (it != _entries.end() && it->second.response) {
+                auto age_ms = (now - it->second.fetch_time_us) / 1000;
+                if (age_ms < FLAGS_metadata_cache_max_stale_ms) {
+                    response = *it->second.response;
+                    if (version) {
+                        *version = it->second.version;
+                    }
+                    served = true;
+                    if (age_ms < FLAGS_metadata_cache_ttl_ms) {
+                        return turbo::OkStatus();
+                    }
+                    /// stale while revalidate
+                    need_refresh = !it->second.refreshing;
+                    it->second.refreshing = true;
+                }
+            }
+        }
+        if (served) {
+            if (need_refresh) {
+                refresh_in_background(key, request);
+            }
+            return turbo::OkStatus();
+        }
+        auto rs = fetch(key, request);
+        std::unique_lock lock(_cache_mutex);
+        auto it = _entries.find(key);
+        if (it == _entries.end() || !it->second.response) {
+            return rs;
+        }
+        if (!rs.ok()) {
+            TLOG_WARN("query discovery fail:{}, return the cached response of {}s ago", rs.message(),
+                      (now - it->second.fetch_time_us) / 1000000);
+        }
+        response = *it->second.response;
+        if (version) {
+            *version = it->second.version;
+        }
+        return turbo::OkStatus();
+    }
+
+    turbo::Status MetadataCache::refresh(const EA::discovery::DiscoveryQueryRequest &request) {
+        return fetch(make_key(request), request);
+    }
+
+    void MetadataCache::invalidate(const EA::discovery::DiscoveryQueryRequest &request) {
+        drop(make_key(request));
+    }
+
+    void MetadataCache::drop(const std::string &key) {
+        std::unique_lock persist_lock(_persist_mutex);
+        {
+            std::unique_lock lock(_cache_mutex);
+            if (_entries.erase(key) == 0) {
+                return;
+            }
+        }
+        if (_persist) {
+            auto rs = _cache_file.remove(key);
+            TURBO_UNUSED(rs);
+        }
+    }
+
+    std::string MetadataCache::make_key(const EA::discovery::DiscoveryQueryRequest &request) {
+        return request.SerializeAsString();
+    }
+
+    turbo::Status MetadataCache::fetch(const std::string &key, const EA::discovery::DiscoveryQueryRequest &request) {
+        auto response = std::make_shared<EA::discovery::DiscoveryQueryResponse>();
+        int retry_time = 0;
+        auto rs = DiscoveryClient::get_instance()->discovery_query(request, *response, &retry_time);
+        if (rs.ok() && response->errcode() != EA::discovery::SUCCESS) {
+            if (is_authoritative(response->errcode())) {
+                /// e.g. the namespace was dropped, the cached response must not be served any more
+                drop(key);
+                return turbo::UnknownError(response->errmsg());
+            }
+            rs = turbo::UnavailableError(response->errmsg());
+        }
+        if (!rs.ok()) {
+            std::unique_lock lock(_cache_mutex);
+            auto it = _entries.find(key);
+            if (it != _entries.end()) {
+                it->second.refreshing = false;
+            }
+            return rs;
+        }
+        std::string data;
+        response->SerializeToString(&data);
+        bool changed = false;
+        {
+            std::unique_lock lock(_cache_mutex);
+            auto &entry = _entries[key];
+            changed = !entry.response || entry.response->SerializeAsString() != data;
+            if (changed) {
+                entry.response = response;
+                ++entry.version;
+            }
+            entry.fetch_time_us = butil::gettimeofday_us();
+            entry.refreshing = false;
+        }
+        if (changed && _persist) {
+            std::unique_lock persist_lock(_persist_mutex);
+            {
+                /// a later fetch or a drop won the race, the file has, or will have, what it published
+                std::unique_lock lock(_cache_mutex);
+                auto it = _entries.find(key);
+                if (it == _entries.end() || it->second.response != response) {
+                    return turbo::OkStatus();
+                }
+            }
+            rs = _cache_file.put(key, data);
+            if (!rs.ok()) {
+                TLOG_WARN("persist metadata cache fail:{}", rs.message());
+            }
+        }
+        return turbo::OkStatus();
+    }
+
+    bool MetadataCache::is_authoritative(EA::discovery::ErrCode errcode) {
+        switch (errcode) {
+            case EA::discovery::HAVE_NOT_INIT:
+            case EA::discovery::NOT_LEADER:
+            case EA::discovery::RETRY_LATER:
+            case EA::discovery::INTERNAL_ERROR:
+                return false;
+            default:
+                return true;
+        }
+    }
+
+    void MetadataCache::refresh_in_background(const std::string &key,
+                                              const EA::discovery::DiscoveryQueryRequest &request) {
+        Bthread bth;
+        bth.run([this, key, request]() {
+            auto rs = fetch(key, request);
+            if (!rs.ok()) {
+                TLOG_WARN("refresh metadata cache fail:{}", rs.message());
+            }
+        });
+    }
+
+}  // namespace EA::client
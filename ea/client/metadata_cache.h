@@ -0,0 +1,117 @@
+// Copyright 2023 The Elastic Architecture Infrastructure Authors.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef EA_CLIENT_METADATA_CACHE_H_
+#define EA_CLIENT_METADATA_CACHE_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include "turbo/base/status.h"
+#include "turbo/container/flat_hash_map.h"
+#include "eapi/discovery/discovery.interface.pb.h"
+#include "ea/client/cache_file.h"
+
+namespace EA::client {
+
+    /**
+     * @ingroup discovery_client
+     * @brief MetadataCache caches the responses of the discovery queries, instances, namespaces, zones,
+     *        servlets, privileges and so on, keyed by the query.
+     *        - a response younger than FLAGS_metadata_cache_ttl_ms is returned without rpc.
+     *        - a response older than that, but younger than FLAGS_metadata_cache_max_stale_ms, is returned
+     *          at once and refreshed in the background, one refresh per query at a time.
+     *        - otherwise the query is sent. If it fails, the cached response is returned however old it is,
+     *          so the services keep resolving while the discovery cluster is unreachable. An error answered
+     *          by the server, e.g. the namespace does not exist, drops the cached response instead.
+     *        Each change of a response bumps its version. The responses are persisted in a CacheFile under
+     *        FLAGS_config_cache_dir, loaded as stale at init, to start up during a discovery outage.
+     *        The watch queries are not cached.
+     * @code
+     *      DiscoveryClient::get_instance()->init(sender);
+     *      MetadataCache::get_instance()->init();
+     *      EA::discovery::DiscoveryQueryRequest request;
+     *      request.set_op_type(EA::discovery::QUERY_INSTANCE_FLATTEN);
+     *      request.set_namespace_name("ns");
+     *      EA::discovery::DiscoveryQueryResponse response;
+     *      auto rs = MetadataCache::get_instance()->query(request, response);
+     * @endcode
+     */
+    class MetadataCache {
+    public:
+        static MetadataCache *get_instance() {
+            static MetadataCache ins;
+            return &ins;
+        }
+
+        /**
+         * @brief init is used to load the persisted responses, it can be called once.
+         * @return Status::OK if the MetadataCache was initialized successfully. Otherwise, an error status is returned.
+         */
+        turbo::Status init();
+
+        /**
+         * @brief query is used to get the response of the query from the cache, or from the discovery server.
+         * @param request [input] is the query.
+         * @param response [output] is the response of the query.
+         * @param version [output] is the version of the response in the cache, it changes when the response changes.
+         * @return Status::OK if a response was got. Otherwise, an error status is returned.
+         */
+        turbo::Status query(const EA::discovery::DiscoveryQueryRequest &request,
+                            EA::discovery::DiscoveryQueryResponse &response, int64_t *version = nullptr);
+
+        /**
+         * @brief refresh is used to send the query and update the cache.
+         * @param request [input] is the query.
+         * @return Status::OK if the query was refreshed successfully. Otherwise, an error status is returned.
+         */
+        turbo::Status refresh(const EA::discovery::DiscoveryQueryRequest &request);
+
+        /**
+         * @brief invalidate is used to drop the response of the query.
+         * @param request [input] is the query.
+         */
+        void invalidate(const EA::discovery::DiscoveryQueryRequest &request);
+
+    private:
+        struct Entry {
+            std::shared_ptr<const EA::discovery::DiscoveryQueryResponse> response;
+            int64_t fetch_time_us{0};
+            int64_t version{0};
+            bool refreshing{false};
+        };
+
+        static std::string make_key(const EA::discovery::DiscoveryQueryRequest &request);
+
+        /// the server answered the query, e.g. not exist, rather than failed to
+        static bool is_authoritative(EA::discovery::ErrCode errcode);
+
+        void drop(const std::string &key);
+
+        turbo::Status fetch(const std::string &key, const EA::discovery::DiscoveryQueryRequest &request);
+
+        void refresh_in_background(const std::string &key, const EA::discovery::DiscoveryQueryRequest &request);
+
+    private:
+        std::mutex _cache_mutex;
+        /// orders the writes of the cache file, taken before _cache_mutex
+        std::mutex _persist_mutex;
+        turbo::flat_hash_map<std::string, Entry> _entries;
+        CacheFile _cache_file;
+        bool _persist{false};
+    };
+
+}  // namespace EA::client
+
+#endif  // EA_CLIENT_METADATA_CACHE_H_
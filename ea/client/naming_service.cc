@@ -0,0 +1,172 @@
+// Copyright 2023 The Elastic Architecture Infrastructure Authors.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "ea/client/naming_service.h"
+#include <mutex>
+#include <bthread/bthread.h>
+#include "turbo/strings/str_split.h"
+#include "ea/client/discovery.h"
+#include "ea/base/tlog.h"
+
+namespace EA::client {
+
+    static const int kMinRetryIntervalMs = 100;
+    static const int kMaxRetryIntervalMs = 5000;
+
+    void DiscoveryNamingService::register_naming_service() {
+        static std::once_flag once;
+        std::call_once(once, [] {
+            brpc::NamingServiceExtension()->RegisterOrDie("ea", new DiscoveryNamingService());
+        });
+    }
+
+    turbo::Status DiscoveryNamingService::parse_service_name(const std::string &service_name) {
+        std::string name = service_name;
+        std::string query;
+        auto pos = service_name.find('?');
+        if (pos != std::string::npos) {
+            name = service_name.substr(0, pos);
+            query = service_name.substr(pos + 1);
+        }
+        std::vector<std::string> parts = turbo::StrSplit(name, '/');
+        if (parts.empty() || parts.size() > 3 || parts[0].empty()) {
+            return turbo::InvalidArgumentError("bad service name {}, expect namespace/zone/servlet", service_name);
+        }
+        _namespace = parts[0];
+        _zone = parts.size() > 1 ? parts[1] : "";
+        _servlet = parts.size() > 2 ? parts[2] : "";
+        if (query.empty()) {
+            return turbo::OkStatus();
+        }
+        std::vector<std::string> params = turbo::StrSplit(query, '&', turbo::SkipEmpty());
+        for (auto &param : params) {
+            auto eq = param.find('=');
+            if (eq == std::string::npos) {
+                return turbo::InvalidArgumentError("bad parameter {} of service name {}", param, service_name);
+            }
+            std::string key = param.substr(0, eq);
+            std::string value = param.substr(eq + 1);
+            if (key == "env") {
+                _env = value;
+            } else if (key == "status") {
+                if (!EA::discovery::Status_Parse(value, &_status)) {
+                    return turbo::InvalidArgumentError("bad status {} of service name {}", value, service_name);
+                }
+            } else {
+                return turbo::InvalidArgumentError("unknown parameter {} of service name {}", key, service_name);
+            }
+        }
+        return turbo::OkStatus();
+    }
+
+    int DiscoveryNamingService::RunNamingService(const char *service_name, brpc::NamingServiceActions *actions) {
+        auto rs = parse_service_name(service_name);
+        if (!rs.ok()) {
+            TLOG_ERROR("{}", rs.message());
+            return -1;
+        }
+        int64_t last_updated_index = 0;
+        int retry_interval_ms = kMinRetryIntervalMs;
+        bool reset = true;
+        while (!bthread_stopped(bthread_self())) {
+            EA::discovery::DiscoveryQueryResponse response;
+            /// the retries, leader redirects and backoff of the sender, the watch timeout covers the server hold
+            rs = DiscoveryClient::get_instance()->watch_instance(_namespace, _zone, _servlet, last_updated_index,
+                                                                 response);
+            if (!rs.ok()) {
+                TLOG_WARN("watch instances of {} fail:{}, retry after {}ms", service_name, rs.message(),
+                          retry_interval_ms);
+                if (bthread_usleep(retry_interval_ms * 1000L) < 0 && errno == ESTOP) {
+                    break;
+                }
+                retry_interval_ms = std::min(retry_interval_ms * 2, kMaxRetryIntervalMs);
+                /// a full list is fetched after the failure, the changes may be lost meanwhile
+                last_updated_index = 0;
+                continue;
+            }
+            retry_interval_ms = kMinRetryIntervalMs;
+            if (!apply_changes(response) && !reset) {
+                continue;
+            }
+            reset = false;
+            std::vector<brpc::ServerNode> servers;
+            get_servers(&servers);
+            TLOG_INFO("instances of {} changed, {} servers, index:{}", service_name, servers.size(),
+                      last_updated_index);
+            actions->ResetServers(servers);
+        }
+        return 0;
+    }
+
+    bool DiscoveryNamingService::apply_changes(const EA::discovery::DiscoveryQueryResponse &response) {
+        if (response.is_full_update()) {
+            turbo::flat_hash_map<std::string, EA::discovery::QueryInstance> instances;
+            for (auto &ins : response.flatten_instances()) {
+                instances[ins.address()] = ins;
+            }
+            _instances.swap(instances);
+            return true;
+        }
+        bool changed = false;
+        for (auto &ins : response.added_instances()) {
+            _instances[ins.address()] = ins;
+            changed = true;
+        }
+        for (auto &ins : response.updated_instances()) {
+            _instances[ins.address()] = ins;
+            changed = true;
+        }
+        for (auto &ins : response.removed_instances()) {
+            changed |= _instances.erase(ins.address()) > 0;
+        }
+        return changed;
+    }
+
+    bool DiscoveryNamingService::accept(const EA::discovery::QueryInstance &instance) const {
+        if (instance.status() != _status) {
+            return false;
+        }
+        return _env.empty() || instance.env() == _env;
+    }
+
+    void DiscoveryNamingService::get_servers(std::vector<brpc::ServerNode> *servers) const {
+        for (auto &it : _instances) {
+            if (!accept(it.second)) {
+                continue;
+            }
+            butil::EndPoint addr;
+            if (butil::str2endpoint(it.first.c_str(), &addr) != 0 &&
+                butil::hostname2endpoint(it.first.c_str(), &addr) != 0) {
+                TLOG_WARN("bad instance address:{}", it.first);
+                continue;
+            }
+            /// weight is the tag for the weighted load balancers, 0 is treated as not set
+            std::string tag = it.second.weight() > 0 ? std::to_string(it.second.weight()) : "";
+            servers->emplace_back(addr, tag);
+        }
+    }
+
+    void DiscoveryNamingService::Describe(std::ostream &os, const brpc::DescribeOptions &) const {
+        os << "ea";
+    }
+
+    brpc::NamingService *DiscoveryNamingService::New() const {
+        return new DiscoveryNamingService();
+    }
+
+    void DiscoveryNamingService::Destroy() {
+        delete this;
+    }
+
+}  // namespace EA::client
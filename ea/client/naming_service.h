@@ -0,0 +1,89 @@
+// Copyright 2023 The Elastic Architecture Infrastructure Authors.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef EA_CLIENT_NAMING_SERVICE_H_
+#define EA_CLIENT_NAMING_SERVICE_H_
+
+#include <string>
+#include <vector>
+#include <brpc/naming_service.h>
+#include "turbo/base/status.h"
+#include "turbo/container/flat_hash_map.h"
+#include "eapi/discovery/discovery.interface.pb.h"
+
+namespace EA::client {
+
+    /**
+     * @ingroup discovery_client
+     * @brief DiscoveryNamingService resolves the instances of a servlet for brpc channels, by the url
+     *        "ea://namespace/zone/servlet". Empty zone or servlet match all, eg "ea://ns//". The instances
+     *        are filtered by the query parameters "status" (NORMAL by default) and "env" (all by default),
+     *        eg "ea://ns/zone/servlet?env=prod&status=NORMAL".
+     *        It keeps the instance list in process and follows the changes by watch_instance of the
+     *        DiscoveryClient, so the channels cost no rpc to the discovery server per call. The weight
+     *        of the instances is given as the tag of the servers, used by the "wrr" and "wr" load balancers.
+     *        The DiscoveryClient must be initialized before the channels are.
+     * @code
+     *      DiscoveryClient::get_instance()->init(sender);
+     *      DiscoveryNamingService::register_naming_service();
+     *      brpc::Channel channel;
+     *      channel.Init("ea://ns/zone/servlet", "wrr", &options);
+     * @endcode
+     */
+    class DiscoveryNamingService : public brpc::NamingService {
+    public:
+        /**
+         * @brief register_naming_service is used to register the "ea" naming service to brpc, it can be
+         *        called many times, the service is registered once.
+         */
+        static void register_naming_service();
+
+        /**
+         * @brief parse_service_name is used to parse "namespace/zone/servlet?key=value&..." into the watch filter.
+         * @return Status::OK if the name is valid. Otherwise, an error status is returned.
+         */
+        turbo::Status parse_service_name(const std::string &service_name);
+
+        int RunNamingService(const char *service_name, brpc::NamingServiceActions *actions) override;
+
+        void Describe(std::ostream &os, const brpc::DescribeOptions &options) const override;
+
+        brpc::NamingService *New() const override;
+
+        void Destroy() override;
+
+    private:
+        /**
+         * @brief apply_changes is used to apply the changes returned by a watch to the cached instances.
+         * @return true if the cached instances changed.
+         */
+        bool apply_changes(const EA::discovery::DiscoveryQueryResponse &response);
+
+        bool accept(const EA::discovery::QueryInstance &instance) const;
+
+        void get_servers(std::vector<brpc::ServerNode> *servers) const;
+
+    private:
+        std::string _namespace;
+        std::string _zone;
+        std::string _servlet;
+        std::string _env;
+        EA::discovery::Status _status{EA::discovery::NORMAL};
+        /// address -> instance, the instances of the servlet not filtered
+        turbo::flat_hash_map<std::string, EA::discovery::QueryInstance> _instances;
+    };
+
+}  // namespace EA::client
+
+#endif  // EA_CLIENT_NAMING_SERVICE_H_
@@ -35,11 +35,13 @@ namespace EA::client {
 
     turbo::Status RouterSender::init(const std::string &server) {
         _server = server;
+        _channel_cache.set_timeout(_timeout_ms, _connect_timeout_ms);
         return turbo::OkStatus();
     }
 
     RouterSender &RouterSender::set_server(const std::string &server) {
         std::unique_lock lk(_server_mutex);
+        _channel_cache.remove_channel(_server);
         _server = server;
         return *this;
     }
@@ -51,11 +53,13 @@ namespace EA::client {
 
     RouterSender &RouterSender::set_time_out(int time_ms) {
         _timeout_ms = time_ms;
+        _channel_cache.set_timeout(_timeout_ms, _connect_timeout_ms);
         return *this;
     }
 
     RouterSender &RouterSender::set_connect_time_out(int time_ms) {
         _connect_timeout_ms = time_ms;
+        _channel_cache.set_timeout(_timeout_ms, _connect_timeout_ms);
         return *this;
     }
 
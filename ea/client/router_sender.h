@@ -26,6 +26,7 @@
 #include "ea/cli/option_context.h"
 #include "eapi/discovery/discovery.interface.pb.h"
 #include "ea/client/base_message_sender.h"
+#include "ea/client/channel_cache.h"
 
 namespace EA::client {
 
@@ -178,6 +179,7 @@ namespace EA::client {
         int _timeout_ms{300};
         int _connect_timeout_ms{500};
         int _between_meta_connect_error_ms{1000};
+        ChannelCache _channel_cache;
     };
 
     template<typename Request, typename Response>
@@ -199,23 +201,26 @@ namespace EA::client {
             }
             brpc::Controller cntl;
             cntl.set_log_id(log_id);
-            //store has leader address
-            brpc::ChannelOptions channel_opt;
-            channel_opt.timeout_ms = _timeout_ms;
-            channel_opt.connect_timeout_ms = _connect_timeout_ms;
-            brpc::Channel short_channel;
-            if (short_channel.Init(_server.c_str(), &channel_opt) != 0) {
-                TLOG_WARN_IF(_verbose, "connect with router server fail. channel Init fail, leader_addr:{}", _server);
+            if (call_timeout_ms(request) > _timeout_ms) {
+                cntl.set_timeout_ms(call_timeout_ms(request));
+            }
+            std::unique_lock lk(_server_mutex);
+            std::string server = _server;
+            lk.unlock();
+            auto channel = _channel_cache.get_channel(server);
+            if (!channel) {
+                TLOG_WARN_IF(_verbose, "connect with router server fail. channel Init fail, leader_addr:{}", server);
                 ++retry_time;
                 continue;
             }
-            short_channel.CallMethod(method, &cntl, &request, &response, nullptr);
+            channel->CallMethod(method, &cntl, &request, &response, nullptr);
 
             TLOG_TRACE_IF(_verbose, "router_req[{}], router_resp[{}]", request.ShortDebugString(),
                           response.ShortDebugString());
             if (cntl.Failed()) {
                 TLOG_WARN_IF(_verbose, "connect with router server fail. send request fail, error:{}, log_id:{}",
                              cntl.ErrorText(), cntl.log_id());
+                _channel_cache.remove_channel(server);
                 ++retry_time;
                 continue;
             }
@@ -15,6 +15,7 @@
 #include "ea/client/utility.h"
 #include "turbo/strings/utility.h"
 #include "turbo/container/flat_hash_set.h"
+#include "butil/third_party/snappy/snappy.h"
 
 namespace EA::client {
 
@@ -132,4 +133,21 @@ namespace EA::client {
         return turbo::OkStatus();
     }
 
+    turbo::Status get_config_content(const EA::discovery::ConfigInfo &config, std::string &content) {
+        switch (config.compress_type()) {
+            case EA::discovery::CONFIG_COMPRESS_NONE:
+                content = config.content();
+                return turbo::OkStatus();
+            case EA::discovery::CONFIG_COMPRESS_SNAPPY:
+                content.clear();
+                if (!butil::snappy::Uncompress(config.content().data(), config.content().size(), &content)) {
+                    return turbo::DataLossError("uncompress config {} fail", config.name());
+                }
+                return turbo::OkStatus();
+            default:
+                return turbo::UnimplementedError("unknown compress type {} of config {}",
+                                                 static_cast<int>(config.compress_type()), config.name());
+        }
+    }
+
 }  // namespace EA::client
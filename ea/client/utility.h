@@ -84,6 +84,16 @@ namespace EA::client {
      */
     [[nodiscard]] turbo::Status check_valid_name_type(std::string_view name);
 
+    /**
+     * @ingroup ea_proto
+     * @brief get_config_content is used to get the plain content of a ConfigInfo, large contents are stored and
+     *        transferred compressed by the meta server, and are decompressed here.
+     * @param config [input] is the ConfigInfo to get the content from.
+     * @param content [output] is the plain content.
+     * @return Status::OK if the content was got successfully. Otherwise, an error status is returned.
+     */
+    turbo::Status get_config_content(const EA::discovery::ConfigInfo &config, std::string &content);
+
 }  // namespace EA::client
 
 #endif // EA_CLIENT_UTILITY_H_
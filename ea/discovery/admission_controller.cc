@@ -0,0 +1,97 @@
+// Copyright 2023 The Elastic AI Search Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "ea/discovery/admission_controller.h"
+#include <algorithm>
+#include "butil/time.h"
+#include "ea/discovery/base_state_machine.h"
+#include "ea/discovery/discovery_rocksdb.h"
+#include "ea/flags/discovery.h"
+#include "ea/flags/engine.h"
+#include "ea/base/tlog.h"
+
+namespace EA::discovery {
+
+    static int64_t get_admission_rate(void *arg) {
+        return static_cast<AdmissionController *>(arg)->rate();
+    }
+
+    AdmissionController::AdmissionController() : _rate(FLAGS_max_tokens_per_second),
+                                                 _reject_count("discovery_admission_reject_count"),
+                                                 _rate_status("discovery_admission_rate", get_admission_rate, this) {
+    }
+
+    void AdmissionController::init(BaseStateMachine *state_machine) {
+        _state_machine = state_machine;
+        _rate = FLAGS_max_tokens_per_second;
+        _last_refill_us = butil::gettimeofday_us();
+        _adjust_bth.run([this]() { adjust_thread(); });
+    }
+
+    void AdmissionController::close() {
+        _shutdown = true;
+        _adjust_bth.join();
+    }
+
+    bool AdmissionController::admit() {
+        if (FLAGS_use_token_bucket == 0) {
+            return true;
+        }
+        int64_t rate = _rate.load();
+        std::unique_lock lock(_bucket_mutex);
+        int64_t now = butil::gettimeofday_us();
+        /// at least one token, a low rate still lets the requests through one by one
+        double capacity = std::max(1.0, rate * FLAGS_token_bucket_burst_window_ms / 1000.0);
+        _tokens = std::min(capacity, _tokens + (now - _last_refill_us) * rate / 1000000.0);
+        _last_refill_us = now;
+        if (_tokens < 1) {
+            lock.unlock();
+            _reject_count << 1;
+            return false;
+        }
+        _tokens -= 1;
+        return true;
+    }
+
+    void AdmissionController::adjust_thread() {
+        while (!_shutdown) {
+            bthread_usleep_fast_shutdown(FLAGS_discovery_admission_adjust_interval_ms * 1000LL, _shutdown);
+            if (_shutdown) {
+                return;
+            }
+            adjust();
+        }
+    }
+
+    void AdmissionController::adjust() {
+        int64_t max_rate = FLAGS_max_tokens_per_second;
+        int64_t min_rate = std::min(max_rate, FLAGS_discovery_admission_min_rate);
+        int64_t rate = std::clamp(_rate.load(), min_rate, max_rate);
+        bool stall = DiscoveryRocksdb::get_instance()->kv()->is_stall();
+        int64_t apply_lag = _state_machine != nullptr ? _state_machine->apply_lag() : 0;
+        int64_t new_rate;
+        if (stall || apply_lag > FLAGS_discovery_admission_max_apply_lag) {
+            new_rate = std::max(min_rate, rate / 2);
+        } else {
+            new_rate = std::min(max_rate, rate + std::max<int64_t>(1, max_rate / 10));
+        }
+        if (new_rate != rate) {
+            TLOG_INFO("admission rate {} -> {}, rocksdb stall:{}, apply lag:{}", rate, new_rate, stall, apply_lag);
+        }
+        _rate = new_rate;
+    }
+
+}  // namespace EA::discovery
@@ -0,0 +1,69 @@
+// Copyright 2023 The Elastic AI Search Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include "bvar/bvar.h"
+#include "ea/base/bthread.h"
+
+namespace EA::discovery {
+
+    class BaseStateMachine;
+
+    /// token bucket in front of discovery_manager, enabled by FLAGS_use_token_bucket.
+    /// the rate starts at FLAGS_max_tokens_per_second, it is halved while rocksdb stalls the writes
+    /// or the raft apply lags behind the commit, and grows back by a tenth of the max otherwise.
+    /// a request without a token is answered RETRY_LATER, the senders back off and retry it.
+    class AdmissionController {
+    public:
+        static AdmissionController *get_instance() {
+            static AdmissionController _instance;
+            return &_instance;
+        }
+
+        /// starts adjusting the rate to the stalls and the apply lag of the state machine
+        void init(BaseStateMachine *state_machine);
+
+        void close();
+
+        /// takes a token, false if the request should be retried later
+        bool admit();
+
+        int64_t rate() const {
+            return _rate.load();
+        }
+
+    private:
+        AdmissionController();
+
+        void adjust_thread();
+
+        void adjust();
+
+        BaseStateMachine *_state_machine = nullptr;
+        std::mutex _bucket_mutex;
+        double _tokens = 0;
+        int64_t _last_refill_us = 0;
+        std::atomic<int64_t> _rate;
+        bool _shutdown = false;
+        Bthread _adjust_bth;
+        bvar::Adder<int64_t> _reject_count;
+        bvar::PassiveStatus<int64_t> _rate_status;
+    };
+
+}  // namespace EA::discovery
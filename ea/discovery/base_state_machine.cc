@@ -76,6 +76,8 @@ namespace EA::discovery {
         //options.stable_uri = FLAGS_discovery_stable_uri + "/discovery_server";
         options.raft_meta_uri = FLAGS_discovery_stable_uri + _file_path;
         options.snapshot_uri = FLAGS_discovery_snapshot_uri + _file_path;
+        /// files of the last local snapshot with the same checksum are linked instead of downloaded
+        options.filter_before_copy_remote = true;
         int ret = _node.init(options);
         if (ret < 0) {
             TLOG_ERROR("raft node init fail");
@@ -150,6 +150,13 @@ namespace EA::discovery {
             _have_data = flag;
         }
 
+        /// entries committed but not applied yet
+        int64_t apply_lag() {
+            braft::NodeStatus status;
+            _node.get_status(&status);
+            return status.committed_index - status.known_applied_index;
+        }
+
     protected:
         braft::Node _node;
         std::atomic<bool> _is_leader;
@@ -16,7 +16,10 @@
 #include "ea/discovery/base_state_machine.h"
 #include "ea/discovery/discovery_rocksdb.h"
 #include "ea/discovery/discovery_constants.h"
+#include "ea/discovery/key_encoder.h"
 #include "ea/base/scope_exit.h"
+#include "ea/flags/discovery.h"
+#include "butil/third_party/snappy/snappy.h"
 
 namespace EA::discovery {
 
@@ -53,7 +56,25 @@ namespace EA::discovery {
         }));
 
         switch (request->op_type()) {
-            case EA::discovery::OP_CREATE_CONFIG:
+            case EA::discovery::OP_CREATE_CONFIG: {
+                if(!request->has_config_info()) {
+                    ERROR_SET_RESPONSE(response, EA::discovery::INPUT_PARAM_ERROR,
+                                       "no config_info", request->op_type(), log_id);
+                    return;
+                }
+                /// compress before proposing, so the raft log, rocksdb and memory all keep the compressed one
+                std::string compressed_content;
+                if(request->config_info().compress_type() == EA::discovery::CONFIG_COMPRESS_NONE &&
+                   compress_content(request->config_info().content(), &compressed_content)) {
+                    EA::discovery::DiscoveryManagerRequest compressed_request(*request);
+                    compressed_request.mutable_config_info()->set_content(std::move(compressed_content));
+                    compressed_request.mutable_config_info()->set_compress_type(EA::discovery::CONFIG_COMPRESS_SNAPPY);
+                    _discovery_state_machine->process(controller, &compressed_request, response, done_guard.release());
+                    return;
+                }
+                _discovery_state_machine->process(controller, request, response, done_guard.release());
+                return;
+            }
             case EA::discovery::OP_REMOVE_CONFIG:
                 if(!request->has_config_info()) {
                     ERROR_SET_RESPONSE(response, EA::discovery::INPUT_PARAM_ERROR,
@@ -69,6 +90,20 @@ namespace EA::discovery {
         }
 
     }
+    bool ConfigManager::compress_content(const std::string &content, std::string *compressed) {
+        if (FLAGS_discovery_config_compress_threshold <= 0 ||
+            content.size() < static_cast<size_t>(FLAGS_discovery_config_compress_threshold)) {
+            return false;
+        }
+        compressed->clear();
+        butil::snappy::Compress(content.data(), content.size(), compressed);
+        // not worth it
+        if (compressed->size() >= content.size()) {
+            return false;
+        }
+        return true;
+    }
+
     void ConfigManager::create_config(const ::EA::discovery::DiscoveryManagerRequest &request, braft::Closure *done) {
         auto &create_request = request.config_info();
         auto &name = create_request.name();
@@ -111,6 +146,8 @@ namespace EA::discovery {
             return;
         }
         it->second[version] = create_request;
+        /// wake up the watchers, every replica applies the log so watchers on followers see it too
+        bthread_cond_broadcast(&_config_cond);
         TLOG_INFO("config :{} version: {} create", name, version.to_string());
         IF_DONE_SET_RESPONSE(done, EA::discovery::SUCCESS, "success");
     }
@@ -176,23 +213,20 @@ namespace EA::discovery {
         IF_DONE_SET_RESPONSE(done, EA::discovery::SUCCESS, "success");
     }
 
-    int ConfigManager::load_snapshot() {
+    int ConfigManager::load_snapshot(rocksdb::Iterator *iter) {
         BAIDU_SCOPED_LOCK( ConfigManager::get_instance()->_config_mutex);
         TLOG_INFO("start to load config snapshot");
         _configs.clear();
         std::string config_prefix = DiscoveryConstants::CONFIG_IDENTIFY;
-        rocksdb::ReadOptions read_options;
-        read_options.prefix_same_as_start = true;
-        read_options.total_order_seek = false;
-        RocksStorage *db = RocksStorage::get_instance();
-        std::unique_ptr<rocksdb::Iterator> iter(
-                db->new_iterator(read_options, db->get_meta_info_handle()));
-        iter->Seek(config_prefix);
-        for (; iter->Valid(); iter->Next()) {
+        if (iter->Valid() && iter->key().compare(config_prefix) < 0) {
+            iter->Seek(config_prefix);
+        }
+        for (; iter->Valid() && iter->key().starts_with(config_prefix); iter->Next()) {
             if(load_config_snapshot(iter->value().ToString()) != 0) {
                 return -1;
             }
         }
+        bthread_cond_broadcast(&ConfigManager::get_instance()->_config_cond);
         TLOG_INFO("load config snapshot done");
         return 0;
     }
@@ -215,7 +249,17 @@ namespace EA::discovery {
     }
 
     std::string ConfigManager::make_config_key(const std::string &name, const turbo::ModuleVersion &version) {
-        return DiscoveryConstants::CONFIG_IDENTIFY + name + version.to_string();
+        std::string key = make_config_prefix(name);
+        KeyEncoder::append_u32(key, version.major);
+        KeyEncoder::append_u32(key, version.minor);
+        KeyEncoder::append_u32(key, version.patch);
+        return key;
+    }
+
+    std::string ConfigManager::make_config_prefix(const std::string &name) {
+        std::string key = DiscoveryConstants::CONFIG_IDENTIFY;
+        KeyEncoder::append_string(key, name);
+        return key;
     }
 
 }  // namespace EA::discovery
\ No newline at end of file
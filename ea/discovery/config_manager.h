@@ -60,15 +60,31 @@ namespace EA::discovery {
         void remove_config(const ::EA::discovery::DiscoveryManagerRequest &request, braft::Closure *done);
 
         ///
+        /// \param iter shared by the managers loading a snapshot in one pass, it is left at the first
+        ///        key after the config keys
         /// \return
-        int load_snapshot();
+        int load_snapshot(rocksdb::Iterator *iter);
 
         ///
         /// \param name
         /// \param version
-        /// \return
+        /// \return the length prefixed name and the big endian version, the versions of a name are adjacent
+        ///         and ascending, the latest one is a SeekForPrev of the next prefix away
         static std::string make_config_key(const std::string &name, const turbo::ModuleVersion &version);
 
+        ///
+        /// \param name
+        /// \return the common prefix of the keys of all versions of the config
+        static std::string make_config_prefix(const std::string &name);
+
+        ///
+        /// \brief snappy compress the content when it is larger than
+        ///        FLAGS_discovery_config_compress_threshold and compressing pays off
+        /// \param content
+        /// \param compressed
+        /// \return true if compressed
+        static bool compress_content(const std::string &content, std::string *compressed);
+
         ///
         /// \param machine
         void set_discovery_state_machine(DiscoveryStateMachine *machine);
@@ -91,6 +107,8 @@ namespace EA::discovery {
     private:
         DiscoveryStateMachine *_discovery_state_machine;
         bthread_mutex_t _config_mutex;
+        /// broadcast with _config_mutex held when a new config version is applied
+        bthread_cond_t _config_cond;
         turbo::flat_hash_map<std::string, std::map<turbo::ModuleVersion, EA::discovery::ConfigInfo>> _configs;
 
     };
@@ -101,9 +119,11 @@ namespace EA::discovery {
 
     inline ConfigManager::ConfigManager() {
         bthread_mutex_init(&_config_mutex, nullptr);
+        bthread_cond_init(&_config_cond, nullptr);
     }
 
     inline ConfigManager::~ConfigManager() {
+        bthread_cond_destroy(&_config_cond);
         bthread_mutex_destroy(&_config_mutex);
     }
 
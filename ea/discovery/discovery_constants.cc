@@ -36,6 +36,10 @@ namespace EA::discovery {
 
     const std::string DiscoveryConstants::MAX_IDENTIFY(1, 0xFF);
 
+    const std::string DiscoveryConstants::META_FORMAT_VERSION_KEY = std::string(1, 0x00) + "meta_format_version";
+    /// 1: big endian ids, length prefixed config names and big endian config versions
+    const int64_t DiscoveryConstants::META_FORMAT_VERSION = 1;
+
     /// for schema
     const std::string DiscoveryConstants::MAX_NAMESPACE_ID_KEY = "max_namespace_id";
     const std::string DiscoveryConstants::MAX_ZONE_ID_KEY = "max_zone_id";
@@ -16,6 +16,7 @@
 #ifndef EA_DISCOVERY_DISCOVERY_CONSTANTS_H_
 #define EA_DISCOVERY_DISCOVERY_CONSTANTS_H_
 
+#include <cstdint>
 #include <string>
 
 namespace EA::discovery {
@@ -39,6 +40,10 @@ namespace EA::discovery {
 
         static const std::string MAX_IDENTIFY;
 
+        /// the version of the key encoding of the meta info, sorted before all the other keys
+        static const std::string META_FORMAT_VERSION_KEY;
+        static const int64_t META_FORMAT_VERSION;
+
         /// for schema
         static const std::string MAX_NAMESPACE_ID_KEY;
         static const std::string MAX_ZONE_ID_KEY;
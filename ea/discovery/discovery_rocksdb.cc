@@ -22,99 +22,78 @@
 namespace EA::discovery {
 
     int DiscoveryRocksdb::init() {
-        _rocksdb = RocksStorage::get_instance();
-        if (!_rocksdb) {
-            TLOG_ERROR("create rocksdb handler failed");
-            return -1;
+        if (FLAGS_discovery_meta_store == "memory") {
+            TLOG_WARN("discovery meta info is kept in memory, rocksdb is not used");
+            return init(std::make_unique<MemoryMetaKV>());
         }
-        int ret = _rocksdb->init(FLAGS_discovery_db_path);
-        if (ret != 0) {
-            TLOG_ERROR("rocksdb init failed: code:{}", ret);
+        if (FLAGS_discovery_meta_store != "rocksdb") {
+            TLOG_ERROR("unknown discovery meta store:{}", FLAGS_discovery_meta_store);
             return -1;
         }
-        _handle = _rocksdb->get_meta_info_handle();
-        TLOG_WARN("rocksdb init success, db_path:{}", FLAGS_discovery_db_path);
-        return 0;
+        return init(std::make_unique<RocksMetaKV>());
     }
 
-    int DiscoveryRocksdb::put_discovery_info(const std::string &key, const std::string &value) {
-        rocksdb::WriteOptions write_option;
-        write_option.disableWAL = true;
-        auto status = _rocksdb->put(write_option, _handle, rocksdb::Slice(key), rocksdb::Slice(value));
-        if (!status.ok()) {
-            TLOG_WARN("put rocksdb fail, err_msg: {}, key: {}, value: {}",
-                       status.ToString(), key, value);
+    int DiscoveryRocksdb::init(std::unique_ptr<MetaKV> kv) {
+        if (kv->init() != 0) {
+            TLOG_ERROR("init discovery meta store {} fail", kv->name());
             return -1;
         }
+        _track_dirty = dynamic_cast<RocksMetaKV *>(kv.get()) != nullptr;
+        _kv = std::move(kv);
         return 0;
     }
 
+    int DiscoveryRocksdb::put_discovery_info(const std::string &key, const std::string &value) {
+        mark_dirty(key);
+        return _kv->put(key, value);
+    }
+
     int DiscoveryRocksdb::put_discovery_info(const std::vector<std::string> &keys,
                                    const std::vector<std::string> &values) {
-        if (keys.size() != values.size()) {
-            TLOG_WARN("input keys'size is not equal to values' size");
-            return -1;
-        }
-        rocksdb::WriteOptions write_option;
-        write_option.disableWAL = true;
-        rocksdb::WriteBatch batch;
-        for (size_t i = 0; i < keys.size(); ++i) {
-            batch.Put(_handle, keys[i], values[i]);
-        }
-        auto status = _rocksdb->write(write_option, &batch);
-        if (!status.ok()) {
-            TLOG_WARN("put batch to rocksdb fail, err_msg: {}",
-                       status.ToString());
-            return -1;
-        }
-        return 0;
+        mark_dirty(keys);
+        return _kv->write(keys, values, {});
     }
 
     int DiscoveryRocksdb::get_discovery_info(const std::string &key, std::string *value) {
-        rocksdb::ReadOptions options;
-        auto status = _rocksdb->get(options, _handle, rocksdb::Slice(key), value);
-        if (!status.ok()) {
-            return -1;
-        }
-        return 0;
+        return _kv->get(key, value) == 0 ? 0 : -1;
     }
 
     int DiscoveryRocksdb::remove_discovery_info(const std::vector<std::string> &keys) {
-        rocksdb::WriteOptions write_option;
-        write_option.disableWAL = true;
-        rocksdb::WriteBatch batch;
-        for (auto &key: keys) {
-            batch.Delete(_handle, key);
-        }
-        auto status = _rocksdb->write(write_option, &batch);
-        if (!status.ok()) {
-            TLOG_WARN("delete batch to rocksdb fail, err_msg: {}", status.ToString());
-            return -1;
-        }
-        return 0;
+        mark_dirty(keys);
+        return _kv->remove(keys);
     }
 
     int DiscoveryRocksdb::write_discovery_info(const std::vector<std::string> &put_keys,
                                      const std::vector<std::string> &put_values,
                                      const std::vector<std::string> &delete_keys) {
-        if (put_keys.size() != put_values.size()) {
-            TLOG_WARN("input keys'size is not equal to values' size");
-            return -1;
-        }
-        rocksdb::WriteOptions write_option;
-        write_option.disableWAL = true;
-        rocksdb::WriteBatch batch;
-        for (size_t i = 0; i < put_keys.size(); ++i) {
-            batch.Put(_handle, put_keys[i], put_values[i]);
-        }
-        for (auto &delete_key: delete_keys) {
-            batch.Delete(_handle, delete_key);
+        mark_dirty(put_keys);
+        mark_dirty(delete_keys);
+        return _kv->write(put_keys, put_values, delete_keys);
+    }
+
+    void DiscoveryRocksdb::swap_dirty_keys(std::set<std::string> &keys) {
+        std::unique_lock lock(_dirty_mutex);
+        _dirty_keys.swap(keys);
+    }
+
+    void DiscoveryRocksdb::clear_dirty_keys() {
+        std::unique_lock lock(_dirty_mutex);
+        _dirty_keys.clear();
+    }
+
+    void DiscoveryRocksdb::mark_dirty(const std::string &key) {
+        if (!_track_dirty) {
+            return;
         }
-        auto status = _rocksdb->write(write_option, &batch);
-        if (!status.ok()) {
-            TLOG_WARN("write batch to rocksdb fail,  {}", status.ToString());
-            return -1;
+        std::unique_lock lock(_dirty_mutex);
+        _dirty_keys.insert(key);
+    }
+
+    void DiscoveryRocksdb::mark_dirty(const std::vector<std::string> &keys) {
+        if (!_track_dirty) {
+            return;
         }
-        return 0;
+        std::unique_lock lock(_dirty_mutex);
+        _dirty_keys.insert(keys.begin(), keys.end());
     }
 }  // namespace EA::discovery
@@ -16,9 +16,15 @@
 
 #pragma once
 
-#include "ea/storage/rocks_storage.h"
+#include <memory>
+#include <mutex>
+#include <set>
+#include "ea/discovery/meta_kv.h"
+#include "ea/discovery/rocks_meta_kv.h"
+#include "ea/discovery/memory_meta_kv.h"
 
 namespace EA::discovery {
+    /// the managers write the meta info through it, into the MetaKV chosen by FLAGS_discovery_meta_store
     class DiscoveryRocksdb {
     public:
         virtual ~DiscoveryRocksdb() {}
@@ -30,6 +36,28 @@ namespace EA::discovery {
 
         int init();
 
+        /// uses the store given instead of the one of the flag, e.g. a MemoryMetaKV to run the managers without disk
+        int init(std::unique_ptr<MetaKV> kv);
+
+        MetaKV *kv() {
+            return _kv.get();
+        }
+
+        /// the store as a RocksMetaKV, nullptr if it is not
+        RocksMetaKV *rocks_kv() {
+            return dynamic_cast<RocksMetaKV *>(_kv.get());
+        }
+
+        /// the store as a MemoryMetaKV, nullptr if it is not
+        MemoryMetaKV *memory_kv() {
+            return dynamic_cast<MemoryMetaKV *>(_kv.get());
+        }
+
+        /// FLAGS_discovery_meta_store=memory, the meta info is in a MemoryMetaKV and rocksdb is not opened
+        bool use_memory_store() {
+            return memory_kv() != nullptr;
+        }
+
         int put_discovery_info(const std::string &key, const std::string &value);
 
         int put_discovery_info(const std::vector<std::string> &keys,
@@ -43,11 +71,23 @@ namespace EA::discovery {
                             const std::vector<std::string> &put_values,
                             const std::vector<std::string> &delete_keys);
 
+        /// keys put or removed since the last call, a delta snapshot saves only them
+        void swap_dirty_keys(std::set<std::string> &keys);
+
+        void clear_dirty_keys();
+
     private:
         DiscoveryRocksdb() {}
 
-        RocksStorage *_rocksdb = nullptr;
-        rocksdb::ColumnFamilyHandle *_handle = nullptr;
+        void mark_dirty(const std::string &key);
+
+        void mark_dirty(const std::vector<std::string> &keys);
+
+        std::unique_ptr<MetaKV> _kv;
+        /// only the rocksdb snapshots are incremental
+        bool _track_dirty = false;
+        std::mutex _dirty_mutex;
+        std::set<std::string> _dirty_keys;
     }; //class
 
 }  // namespace EA::discovery
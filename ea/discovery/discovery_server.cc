@@ -28,6 +28,7 @@
 #include "ea/discovery/query_zone_manager.h"
 #include "ea/discovery/query_servlet_manager.h"
 #include "ea/discovery/discovery_rocksdb.h"
+#include "ea/discovery/admission_controller.h"
 
 namespace EA::discovery {
 
@@ -85,6 +86,7 @@ namespace EA::discovery {
         ConfigManager::get_instance()->set_discovery_state_machine(_discovery_state_machine);
         PrivilegeManager::get_instance()->set_discovery_state_machine(_discovery_state_machine);
         _flush_bth.run([this]() { flush_memtable_thread(); });
+        AdmissionController::get_instance()->init(_discovery_state_machine);
         _init_success = true;
         return 0;
     }
@@ -95,20 +97,25 @@ namespace EA::discovery {
             if (_shutdown) {
                 return;
             }
-            auto rocksdb = RocksStorage::get_instance();
-            rocksdb::FlushOptions flush_options;
-            auto status = rocksdb->flush(flush_options, rocksdb->get_meta_info_handle());
-            if (!status.ok()) {
-                TLOG_WARN("flush discovery info to rocksdb fail, err_msg:{}", status.ToString());
-            }
-            status = rocksdb->flush(flush_options, rocksdb->get_raft_log_handle());
-            if (!status.ok()) {
-                TLOG_WARN("flush log_cf to rocksdb fail, err_msg:{}", status.ToString());
-            }
+            DiscoveryRocksdb::get_instance()->kv()->flush();
         }
     }
 
 
+    bool DiscoveryServer::reject_if_busy(const EA::discovery::DiscoveryManagerRequest *request,
+                                         EA::discovery::DiscoveryManagerResponse *response, uint64_t log_id) {
+        /// the followers redirect as before, the tokens are taken by the leader only
+        if (!_discovery_state_machine->is_leader() || AdmissionController::get_instance()->admit()) {
+            return false;
+        }
+        TLOG_WARN("discovery manager busy, reject request, op_type:{}, log_id:{}",
+                  EA::discovery::OpType_Name(request->op_type()), log_id);
+        response->set_errcode(EA::discovery::RETRY_LATER);
+        response->set_errmsg("server busy, retry later");
+        response->set_op_type(request->op_type());
+        return true;
+    }
+
     void DiscoveryServer::discovery_manager(google::protobuf::RpcController *controller,
                                   const EA::discovery::DiscoveryManagerRequest *request,
                                   EA::discovery::DiscoveryManagerResponse *response,
@@ -125,6 +132,9 @@ namespace EA::discovery {
             || request->op_type() == EA::discovery::OP_DROP_USER
             || request->op_type() == EA::discovery::OP_ADD_PRIVILEGE
             || request->op_type() == EA::discovery::OP_DROP_PRIVILEGE) {
+            if (reject_if_busy(request, response, log_id)) {
+                return;
+            }
             PrivilegeManager::get_instance()->process_user_privilege(controller,
                                                                      request,
                                                                      response,
@@ -145,6 +155,9 @@ namespace EA::discovery {
             || request->op_type() == EA::discovery::OP_UPDATE_INSTANCE
             || request->op_type() == EA::discovery::OP_MODIFY_RESOURCE_TAG
             || request->op_type() == EA::discovery::OP_UPDATE_MAIN_LOGICAL_ROOM) {
+            if (reject_if_busy(request, response, log_id)) {
+                return;
+            }
             SchemaManager::get_instance()->process_schema_info(controller,
                                                                request,
                                                                response,
@@ -153,6 +166,9 @@ namespace EA::discovery {
         }
         if(request->op_type() == EA::discovery::OP_CREATE_CONFIG
             ||request->op_type() == EA::discovery::OP_REMOVE_CONFIG) {
+            if (reject_if_busy(request, response, log_id)) {
+                return;
+            }
             ConfigManager::get_instance()->process_schema_info(controller,
                                                                request,
                                                                response,
@@ -224,6 +240,14 @@ namespace EA::discovery {
                 QueryConfigManager::get_instance()->list_config_version(request, response);
                 break;
             }
+            case EA::discovery::QUERY_MULTI_GET_CONFIG: {
+                QueryConfigManager::get_instance()->multi_get_config(request, response);
+                break;
+            }
+            case EA::discovery::QUERY_WATCH_CONFIG: {
+                QueryConfigManager::get_instance()->watch_config(request, response);
+                break;
+            }
 
             case EA::discovery::QUERY_PRIVILEGE_FLATTEN: {
                 QueryPrivilegeManager::get_instance()->get_flatten_servlet_privilege(request, response);
@@ -237,6 +261,10 @@ namespace EA::discovery {
                 QueryInstanceManager::get_instance()->query_instance_flatten(request, response);
                 break;
             }
+            case EA::discovery::QUERY_INSTANCE_WATCH: {
+                QueryInstanceManager::get_instance()->watch_instance(request, response);
+                break;
+            }
 
             default: {
                 TLOG_WARN("invalid op_type, request:{} logid:{}",
@@ -313,6 +341,7 @@ namespace EA::discovery {
     void DiscoveryServer::close() {
         _flush_bth.join();
         TLOG_INFO("DiscoveryServer flush joined");
+        AdmissionController::get_instance()->close();
     }
 
 }  // namespace EA::discovery
@@ -74,6 +74,11 @@ namespace EA::discovery {
     private:
         DiscoveryServer() {}
 
+        /// sheds the request before it is proposed to the discovery state machine on the leader,
+        /// the queue would only turn into timeouts. true if it is rejected with RETRY_LATER
+        bool reject_if_busy(const EA::discovery::DiscoveryManagerRequest *request,
+                            EA::discovery::DiscoveryManagerResponse *response, uint64_t log_id);
+
         bthread::Mutex discovery_nteract_mutex;
         DiscoveryStateMachine *_discovery_state_machine = nullptr;
         AutoIncrStateMachine *_auto_incr_state_machine = nullptr;
@@ -15,9 +15,18 @@
 
 
 #include "ea/discovery/discovery_state_machine.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cinttypes>
+#include <functional>
 #include <braft/util.h>
 #include <braft/storage.h>
-#include "ea/base/scope_exit.h"
+#include <braft/local_file_meta.pb.h>
+#include <butil/crc32c.h>
+#include <butil/errno.h>
+#include <butil/file_util.h>
+#include "turbo/files/filesystem.h"
 #include "ea/discovery/privilege_manager.h"
 #include "ea/discovery/schema_manager.h"
 #include "ea/discovery/config_manager.h"
@@ -25,13 +34,27 @@
 #include "ea/discovery/zone_manager.h"
 #include "ea/discovery/instance_manager.h"
 #include "ea/discovery/servlet_manager.h"
-#include "ea/storage/rocks_storage.h"
 #include "ea/discovery/query_privilege_manager.h"
 #include "ea/storage/sst_file_writer.h"
 #include "ea/discovery/parse_path.h"
+#include "ea/discovery/discovery_rocksdb.h"
+#include "ea/discovery/key_encoder.h"
 
 namespace EA::discovery {
 
+    /// saved before the snapshots were incremental, loaded as a base
+    static const char *kLegacySnapshotFile = "/discovery_info.sst";
+    static const char *kSnapshotBasePrefix = "/discovery_base_";
+    static const char *kSnapshotDeltaPrefix = "/discovery_delta_";
+    /// the snapshot of the memory meta store
+    static const char *kMemorySnapshotFile = "/discovery_meta.bin";
+
+    static std::string snapshot_file_name(const char *prefix, int64_t index) {
+        char name[64];
+        snprintf(name, sizeof(name), "%s%020" PRId64 ".sst", prefix, index);
+        return name;
+    }
+
 
     void DiscoveryStateMachine::on_apply(braft::Iterator &iter) {
         for (; iter.valid(); iter.next()) {
@@ -121,15 +144,15 @@ namespace EA::discovery {
                     break;
                 }
                 case EA::discovery::OP_ADD_INSTANCE: {
-                    InstanceManager::get_instance()->add_instance(request, done);
+                    InstanceManager::get_instance()->add_instance(request, iter.index(), done);
                     break;
                 }
                 case EA::discovery::OP_DROP_INSTANCE: {
-                    InstanceManager::get_instance()->drop_instance(request, done);
+                    InstanceManager::get_instance()->drop_instance(request, iter.index(), done);
                     break;
                 }
                 case EA::discovery::OP_UPDATE_INSTANCE: {
-                    InstanceManager::get_instance()->update_instance(request, done);
+                    InstanceManager::get_instance()->update_instance(request, iter.index(), done);
                     break;
                 }
                 default: {
@@ -150,49 +173,157 @@ namespace EA::discovery {
                    " when on snapshot save",
                    NamespaceManager::get_instance()->get_max_namespace_id(),
                    ZoneManager::get_instance()->get_max_zone_id());
-        //创建snapshot
-        rocksdb::ReadOptions read_options;
-        read_options.prefix_same_as_start = false;
-        read_options.total_order_seek = true;
-        auto iter = RocksStorage::get_instance()->new_iterator(read_options,
-                                                               RocksStorage::get_instance()->get_meta_info_handle());
-        iter->SeekToFirst();
+        /// only the snapshot is taken on the apply thread, a sequence number or the map, the iterator is
+        /// created in the background, so memtables and sst files are not pinned while the apply thread goes on
+        auto snapshot = DiscoveryRocksdb::get_instance()->kv()->snapshot();
+        int64_t index = _applied_index;
+        if (DiscoveryRocksdb::get_instance()->use_memory_store()) {
+            Bthread bth(&BTHREAD_ATTR_SMALL);
+            bth.run([this, done, snapshot, index, writer]() {
+                save_memory_snapshot(done, snapshot, index, writer);
+            });
+            return;
+        }
+        /// no apply runs meanwhile, the dirty keys are exactly the changes since the last snapshot
+        auto dirty_keys = std::make_shared<std::set<std::string>>();
+        DiscoveryRocksdb::get_instance()->swap_dirty_keys(*dirty_keys);
         Bthread bth(&BTHREAD_ATTR_SMALL);
-        std::function<void()> save_snapshot_function = [this, done, iter, writer]() {
-            save_snapshot(done, iter, writer);
+        std::function<void()> save_snapshot_function = [this, done, snapshot, index, dirty_keys, writer]() {
+            save_snapshot(done, snapshot, index, dirty_keys, writer);
         };
         bth.run(save_snapshot_function);
     }
 
     void DiscoveryStateMachine::save_snapshot(braft::Closure *done,
-                                         rocksdb::Iterator *iter,
+                                         const std::shared_ptr<MetaKVSnapshot> &snapshot,
+                                         int64_t index,
+                                         const std::shared_ptr<std::set<std::string>> &dirty_keys,
                                          braft::SnapshotWriter *writer) {
         brpc::ClosureGuard done_guard(done);
-        std::unique_ptr<rocksdb::Iterator> iter_lock(iter);
+        TimeCost time_cost;
+        if (do_save_snapshot(snapshot.get(), index, *dirty_keys, writer) != 0) {
+            done->status().set_error(EINVAL, "Fail to save snapshot");
+            /// the dirty keys taken are lost, the next snapshot starts a new base
+            std::unique_lock lock(_snapshot_mutex);
+            _snapshot_files.clear();
+            return;
+        }
+        TLOG_INFO("save snapshot done, path:{}, index:{}, time_cost:{}us", writer->get_path(), index,
+                  time_cost.get_time());
+    }
 
-        std::string snapshot_path = writer->get_path();
-        std::string sst_file_path = snapshot_path + "/discovery_info.sst";
+    void DiscoveryStateMachine::save_memory_snapshot(braft::Closure *done,
+                                                     const std::shared_ptr<MetaKVSnapshot> &snapshot,
+                                                     int64_t index,
+                                                     braft::SnapshotWriter *writer) {
+        brpc::ClosureGuard done_guard(done);
+        TimeCost time_cost;
+        std::string file_path = writer->get_path() + kMemorySnapshotFile;
+        int64_t key_count = 0;
+        uint64_t size = 0;
+        braft::LocalFileMeta meta;
+        std::string checksum;
+        if (DiscoveryRocksdb::get_instance()->memory_kv()->save(snapshot, file_path, &key_count, &size) != 0 ||
+            file_checksum(file_path, &checksum) != 0) {
+            done->status().set_error(EINVAL, "Fail to save snapshot");
+            return;
+        }
+        meta.set_checksum(checksum);
+        if (writer->add_file(kMemorySnapshotFile, &meta) != 0) {
+            TLOG_WARN("Error while adding file {} to writer", kMemorySnapshotFile);
+            done->status().set_error(EINVAL, "Fail to save snapshot");
+            return;
+        }
+        TLOG_INFO("save memory snapshot done, path:{}, index:{}, keys:{}, bytes:{}, time_cost:{}us",
+                  writer->get_path(), index, key_count, size, time_cost.get_time());
+    }
 
-        rocksdb::Options option = RocksStorage::get_instance()->get_options(
-                RocksStorage::get_instance()->get_meta_info_handle());
-        SstFileWriter sst_writer(option);
+    int DiscoveryStateMachine::do_save_snapshot(MetaKVSnapshot *snapshot,
+                                                int64_t index,
+                                                const std::set<std::string> &dirty_keys,
+                                                braft::SnapshotWriter *writer) {
+        std::vector<SnapshotFile> files;
+        {
+            std::unique_lock lock(_snapshot_mutex);
+            files = _snapshot_files;
+        }
+        std::string snapshot_path = writer->get_path();
         TLOG_WARN("snapshot path:{}", snapshot_path);
+        bool full = files.empty() || files.size() > static_cast<size_t>(FLAGS_discovery_snapshot_max_deltas);
+        if (!full) {
+            /// once the deltas outgrow the base, a new base is cheaper to install
+            uint64_t delta_size = 0;
+            for (size_t i = 1; i < files.size(); ++i) {
+                delta_size += files[i].size;
+            }
+            full = delta_size > files[0].size;
+        }
+        if (!full && !dirty_keys.empty() && files.back().index >= index) {
+            /// never write over a file linked from the last snapshot
+            full = true;
+        }
+        if (!full && link_snapshot_files(files, snapshot_path) != 0) {
+            full = true;
+        }
+        if (full) {
+            files.clear();
+            SnapshotFile base;
+            base.index = index;
+            base.name = snapshot_file_name(kSnapshotBasePrefix, index);
+            if (write_base_file(snapshot, snapshot_path, &base) != 0) {
+                return -1;
+            }
+            files.push_back(base);
+        } else if (!dirty_keys.empty()) {
+            SnapshotFile delta;
+            delta.index = index;
+            delta.is_delta = true;
+            delta.name = snapshot_file_name(kSnapshotDeltaPrefix, index);
+            if (write_delta_file(snapshot, dirty_keys, snapshot_path, &delta) != 0) {
+                return -1;
+            }
+            files.push_back(delta);
+        }
+        for (auto &file: files) {
+            /// followers skip downloading the files they have with the same checksum
+            braft::LocalFileMeta meta;
+            meta.set_checksum(file.checksum);
+            if (writer->add_file(file.name, &meta) != 0) {
+                TLOG_WARN("Error while adding file {} to writer", file.name);
+                return -1;
+            }
+        }
+        TLOG_INFO("save {} snapshot, path:{}, files:{}, dirty keys:{}", full ? "full" : "delta", snapshot_path,
+                  files.size(), dirty_keys.size());
+        std::unique_lock lock(_snapshot_mutex);
+        _snapshot_files = files;
+        return 0;
+    }
+
+    int DiscoveryStateMachine::write_base_file(MetaKVSnapshot *snapshot,
+                                               const std::string &snapshot_path,
+                                               SnapshotFile *file) {
+        std::unique_ptr<rocksdb::Iterator> iter(snapshot->new_iterator(""));
+        iter->SeekToFirst();
+        int64_t key_count = 0;
+        std::string sst_file_path = snapshot_path + file->name;
+
+        SstFileWriter sst_writer(DiscoveryRocksdb::get_instance()->rocks_kv()->options());
         //Open the file for writing
         auto s = sst_writer.open(sst_file_path);
         if (!s.ok()) {
             TLOG_WARN("Error while opening file {}, Error: {}", sst_file_path,
                        s.ToString());
-            done->status().set_error(EINVAL, "Fail to open SstFileWriter");
-            return;
+            return -1;
         }
         for (; iter->Valid(); iter->Next()) {
+            ++key_count;
             auto res = sst_writer.put(iter->key(), iter->value());
             if (!res.ok()) {
                 TLOG_WARN("Error while adding Key: {}, Error: {}",
                            iter->key().ToString(),
-                           s.ToString());
-                done->status().set_error(EINVAL, "Fail to write SstFileWriter");
-                return;
+                           res.ToString());
+                return -1;
             }
         }
         //close the file
@@ -200,89 +331,385 @@ namespace EA::discovery {
         if (!s.ok()) {
             TLOG_WARN("Error while finishing file {}, Error: {}", sst_file_path,
                        s.ToString());
-            done->status().set_error(EINVAL, "Fail to finish SstFileWriter");
-            return;
+            return -1;
         }
-        if (writer->add_file("/discovery_info.sst") != 0) {
-            done->status().set_error(EINVAL, "Fail to add file");
-            TLOG_WARN("Error while adding file to writer");
-            return;
+        file->size = sst_writer.file_size();
+        if (file_checksum(sst_file_path, &file->checksum) != 0) {
+            TLOG_WARN("Error while checksum file {}", sst_file_path);
+            return -1;
+        }
+        TLOG_INFO("write snapshot base file {}, keys:{}, bytes:{}", sst_file_path, key_count, file->size);
+        return 0;
+    }
+
+    int DiscoveryStateMachine::write_delta_file(MetaKVSnapshot *snapshot,
+                                                const std::set<std::string> &keys,
+                                                const std::string &snapshot_path,
+                                                SnapshotFile *file) {
+        std::string sst_file_path = snapshot_path + file->name;
+        SstFileWriter sst_writer(DiscoveryRocksdb::get_instance()->rocks_kv()->options());
+        auto s = sst_writer.open(sst_file_path);
+        if (!s.ok()) {
+            TLOG_WARN("Error while opening file {}, Error: {}", sst_file_path, s.ToString());
+            return -1;
+        }
+        int64_t remove_count = 0;
+        /// the keys are sorted as the sst requires, a key gone at the snapshot is written as a tombstone
+        for (auto &key: keys) {
+            std::string value;
+            auto ret = snapshot->get(key, &value);
+            if (ret < 0) {
+                return -1;
+            }
+            if (ret == 0) {
+                s = sst_writer.put(key, value);
+            } else {
+                ++remove_count;
+                s = sst_writer.remove(key);
+            }
+            if (!s.ok()) {
+                TLOG_WARN("Error while adding Key: {}, Error: {}", key, s.ToString());
+                return -1;
+            }
+        }
+        s = sst_writer.finish();
+        if (!s.ok()) {
+            TLOG_WARN("Error while finishing file {}, Error: {}", sst_file_path, s.ToString());
+            return -1;
+        }
+        file->size = sst_writer.file_size();
+        if (file_checksum(sst_file_path, &file->checksum) != 0) {
+            TLOG_WARN("Error while checksum file {}", sst_file_path);
+            return -1;
+        }
+        TLOG_INFO("write snapshot delta file {}, keys:{}, removed:{}, bytes:{}", sst_file_path, keys.size(),
+                  remove_count, file->size);
+        return 0;
+    }
+
+    int DiscoveryStateMachine::link_snapshot_files(const std::vector<SnapshotFile> &files,
+                                                   const std::string &snapshot_path) {
+        /// braft keeps the last snapshot beside the one being written
+        std::error_code ec;
+        std::string last_path;
+        int64_t last_index = -1;
+        auto parent = turbo::filesystem::path(snapshot_path).parent_path();
+        for (auto &entry: turbo::filesystem::directory_iterator(parent, ec)) {
+            auto name = entry.path().filename().string();
+            if (name.compare(0, 9, "snapshot_") != 0) {
+                continue;
+            }
+            auto snapshot_index = parse_snapshot_index_from_path(entry.path().string(), false);
+            if (snapshot_index > last_index) {
+                last_index = snapshot_index;
+                last_path = entry.path().string();
+            }
+        }
+        if (ec || last_path.empty()) {
+            TLOG_WARN("no last snapshot beside {}, save a full snapshot", snapshot_path);
+            return -1;
         }
+        for (size_t i = 0; i < files.size(); ++i) {
+            auto from = last_path + files[i].name;
+            auto to = snapshot_path + files[i].name;
+            if (::link(from.c_str(), to.c_str()) != 0) {
+                TLOG_WARN("link snapshot file {} to {} fail:{}, save a full snapshot", from, to, berror());
+                for (size_t j = 0; j < i; ++j) {
+                    ::unlink((snapshot_path + files[j].name).c_str());
+                }
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    bool DiscoveryStateMachine::parse_snapshot_file(const std::string &name, SnapshotFile *file) {
+        static const std::string kSuffix = ".sst";
+        file->name = name;
+        if (name == kLegacySnapshotFile) {
+            file->index = 0;
+            file->is_delta = false;
+            return true;
+        }
+        if (name.size() <= kSuffix.size() ||
+            name.compare(name.size() - kSuffix.size(), kSuffix.size(), kSuffix) != 0) {
+            return false;
+        }
+        std::string prefix;
+        if (name.rfind(kSnapshotBasePrefix, 0) == 0) {
+            prefix = kSnapshotBasePrefix;
+            file->is_delta = false;
+        } else if (name.rfind(kSnapshotDeltaPrefix, 0) == 0) {
+            prefix = kSnapshotDeltaPrefix;
+            file->is_delta = true;
+        } else {
+            return false;
+        }
+        file->index = atoll(name.substr(prefix.size(), name.size() - prefix.size() - kSuffix.size()).c_str());
+        return true;
+    }
+
+    int DiscoveryStateMachine::file_checksum(const std::string &path, std::string *checksum) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return -1;
+        }
+        uint32_t crc = 0;
+        std::string buf(1024 * 1024, '\0');
+        while (true) {
+            ssize_t n = ::read(fd, buf.data(), buf.size());
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                ::close(fd);
+                return -1;
+            }
+            if (n == 0) {
+                break;
+            }
+            crc = butil::crc32c::Extend(crc, buf.data(), n);
+        }
+        ::close(fd);
+        char hex[16];
+        snprintf(hex, sizeof(hex), "%08x", crc);
+        *checksum = hex;
+        return 0;
     }
 
     int DiscoveryStateMachine::on_snapshot_load(braft::SnapshotReader *reader) {
         TLOG_WARN("start on snapshot load");
-        //先删除数据
-        std::string remove_start_key(DiscoveryConstants::SCHEMA_IDENTIFY);
-        rocksdb::WriteOptions options;
-        auto status = RocksStorage::get_instance()->remove_range(options,
-                                                                 RocksStorage::get_instance()->get_meta_info_handle(),
-                                                                 remove_start_key,
-                                                                 DiscoveryConstants::MAX_IDENTIFY,
-                                                                 false);
-        if (!status.ok()) {
-            TLOG_ERROR("remove_range error when on snapshot load: code={}, msg={}",
-                     status.code(), status.ToString());
+        std::string snapshot_path = reader->get_path();
+        std::vector<std::string> names;
+        reader->list_files(&names);
+        if (DiscoveryRocksdb::get_instance()->use_memory_store()) {
+            return load_memory_snapshot(reader, names);
+        }
+        if (std::find(names.begin(), names.end(), kMemorySnapshotFile) != names.end()) {
+            TLOG_ERROR("snapshot {} is saved by the memory meta store, the raft group should use the same store",
+                       snapshot_path);
+            return -1;
+        }
+        std::vector<SnapshotFile> files;
+        for (auto &name: names) {
+            TLOG_WARN("snapshot load file:{}", name);
+            SnapshotFile file;
+            if (!parse_snapshot_file(name, &file)) {
+                continue;
+            }
+            braft::LocalFileMeta meta;
+            if (reader->get_file_meta(name, &meta) == 0) {
+                file.checksum = meta.checksum();
+            }
+            int64_t size = 0;
+            if (butil::GetFileSize(butil::FilePath(snapshot_path + name), &size)) {
+                file.size = size;
+            }
+            files.push_back(file);
+        }
+        /// the base first, then the deltas in the order they were saved
+        std::sort(files.begin(), files.end(), [](const SnapshotFile &lhs, const SnapshotFile &rhs) {
+            if (lhs.is_delta != rhs.is_delta) {
+                return !lhs.is_delta;
+            }
+            return lhs.index < rhs.index;
+        });
+        if (!files.empty() && (files[0].is_delta || (files.size() > 1 && !files[1].is_delta))) {
+            TLOG_ERROR("snapshot {} should have one base file", snapshot_path);
             return -1;
-        } else {
-            TLOG_WARN("remove range success when on snapshot load:code:{}, msg={}",
-                       status.code(), status.ToString());
-        }
-        TLOG_WARN("clear data success");
-        rocksdb::ReadOptions read_options;
-        std::unique_ptr<rocksdb::Iterator> iter(RocksStorage::get_instance()->new_iterator(read_options,
-                                                                                           RocksStorage::get_instance()->get_meta_info_handle()));
-        iter->Seek(DiscoveryConstants::SCHEMA_IDENTIFY);
-        for (; iter->Valid(); iter->Next()) {
-            TLOG_WARN("iter key:{}, iter value:{} when on snapshot load",
-                       iter->key().ToString(), iter->value().ToString());
         }
-        std::vector<std::string> files;
-        reader->list_files(&files);
+        //恢复文件
+        std::vector<std::string> file_paths;
         for (auto &file: files) {
-            TLOG_WARN("snapshot load file:{}", file);
-            if (file == "/discovery_info.sst") {
-                std::string snapshot_path = reader->get_path();
-                _applied_index = parse_snapshot_index_from_path(snapshot_path, false);
-                TLOG_WARN("_applied_index:{} path:{}", _applied_index, snapshot_path);
-                snapshot_path.append("/discovery_info.sst");
-
-                //恢复文件
-                rocksdb::IngestExternalFileOptions ifo;
-                auto res = RocksStorage::get_instance()->ingest_external_file(
-                        RocksStorage::get_instance()->get_meta_info_handle(),
-                        {snapshot_path},
-                        ifo);
-                if (!res.ok()) {
-                    TLOG_WARN("Error while ingest file {}, Error {}",
-                               snapshot_path, res.ToString());
-                    return -1;
+            file_paths.push_back(snapshot_path + file.name);
+        }
+        auto kv = DiscoveryRocksdb::get_instance()->rocks_kv();
+        if (kv->ingest(file_paths) != 0) {
+            return -1;
+        }
+        bool migrated = false;
+        if (!files.empty()) {
+            _applied_index = parse_snapshot_index_from_path(snapshot_path, false);
+            TLOG_WARN("_applied_index:{} path:{}", _applied_index, snapshot_path);
+            if (migrate_meta_format(&migrated) != 0) {
+                return -1;
+            }
+            std::unique_ptr<rocksdb::Iterator> iter(kv->snapshot()->new_iterator(""));
+            iter->SeekToFirst();
+            if (load_managers(iter.get()) != 0) {
+                return -1;
+            }
+        }
+        /// the data is the snapshot now, the next delta is based on its files
+        DiscoveryRocksdb::get_instance()->clear_dirty_keys();
+        {
+            std::unique_lock lock(_snapshot_mutex);
+            /// the files miss the keys rewritten and the format stamp, the next snapshot is a new base
+            if (migrated) {
+                files.clear();
+            }
+            _snapshot_files = files;
+        }
+        set_have_data(true);
+        return 0;
+    }
 
-                }
-                auto ret = PrivilegeManager::get_instance()->load_snapshot();
-                if (ret != 0) {
-                    TLOG_ERROR("PrivilegeManager load snapshot fail");
-                    return -1;
-                }
-                ret = SchemaManager::get_instance()->load_snapshot();
-                if (ret != 0) {
-                    TLOG_ERROR("SchemaManager load snapshot fail");
+    int DiscoveryStateMachine::load_memory_snapshot(braft::SnapshotReader *reader,
+                                                    const std::vector<std::string> &names) {
+        std::string snapshot_path = reader->get_path();
+        if (std::find(names.begin(), names.end(), kMemorySnapshotFile) == names.end()) {
+            for (auto &name: names) {
+                SnapshotFile file;
+                if (parse_snapshot_file(name, &file)) {
+                    TLOG_ERROR("snapshot {} is saved by the rocksdb meta store, the raft group should use the same store",
+                               snapshot_path);
                     return -1;
                 }
+            }
+            set_have_data(true);
+            return 0;
+        }
+        auto kv = DiscoveryRocksdb::get_instance()->memory_kv();
+        if (kv->load(snapshot_path + kMemorySnapshotFile) != 0) {
+            return -1;
+        }
+        _applied_index = parse_snapshot_index_from_path(snapshot_path, false);
+        TLOG_WARN("_applied_index:{} path:{}", _applied_index, snapshot_path);
+        bool migrated = false;
+        if (migrate_meta_format(&migrated) != 0) {
+            return -1;
+        }
+        std::unique_ptr<rocksdb::Iterator> iter(kv->snapshot()->new_iterator(""));
+        iter->SeekToFirst();
+        if (load_managers(iter.get()) != 0) {
+            return -1;
+        }
+        set_have_data(true);
+        return 0;
+    }
+
+    int DiscoveryStateMachine::load_managers(rocksdb::Iterator *iter) {
+        auto ret = SchemaManager::get_instance()->load_snapshot(iter);
+        if (ret != 0) {
+            TLOG_ERROR("SchemaManager load snapshot fail");
+            return -1;
+        }
+        ret = PrivilegeManager::get_instance()->load_snapshot(iter);
+        if (ret != 0) {
+            TLOG_ERROR("PrivilegeManager load snapshot fail");
+            return -1;
+        }
+        ret = InstanceManager::get_instance()->load_snapshot(iter, _applied_index);
+        if (ret != 0) {
+            TLOG_ERROR("Instance load snapshot fail");
+            return -1;
+        }
+        ret = ConfigManager::get_instance()->load_snapshot(iter);
+        if (ret != 0) {
+            TLOG_ERROR("ConfigManager load snapshot fail");
+            return -1;
+        }
+        return 0;
+    }
 
-                ret = ConfigManager::get_instance()->load_snapshot();
-                if (ret != 0) {
-                    TLOG_ERROR("ConfigManager load snapshot fail");
+    int DiscoveryStateMachine::migrate_meta_format(bool *migrated) {
+        *migrated = false;
+        auto kv = DiscoveryRocksdb::get_instance()->kv();
+        std::string version_value;
+        int ret = kv->get(DiscoveryConstants::META_FORMAT_VERSION_KEY, &version_value);
+        if (ret < 0) {
+            return -1;
+        }
+        int64_t version = 0;
+        if (ret == 0 && version_value.size() == sizeof(int64_t)) {
+            version = static_cast<int64_t>(KeyEncoder::decode_u64(version_value));
+        }
+        if (version >= DiscoveryConstants::META_FORMAT_VERSION) {
+            return 0;
+        }
+        std::vector<std::string> put_keys;
+        std::vector<std::string> put_values;
+        std::vector<std::string> delete_keys;
+        int64_t record_count = 0;
+        /// the keys of the prefix are rebuilt from the values, make_key returns false if a value is broken
+        auto rekey = [&](const std::string &prefix,
+                         const std::function<bool(const std::string &, std::string *)> &make_key) -> int {
+            std::unique_ptr<rocksdb::Iterator> iter(kv->snapshot()->new_iterator(prefix));
+            for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+                ++record_count;
+                std::string value = iter->value().ToString();
+                std::string key;
+                if (!make_key(value, &key)) {
+                    TLOG_ERROR("parse meta info fail when migrate, prefix:{}", prefix);
                     return -1;
                 }
-                ret = InstanceManager::get_instance()->load_snapshot();
-                if (ret != 0) {
-                    TLOG_ERROR("Instance load snapshot fail");
-                    return -1;
+                if (key == iter->key().ToString()) {
+                    continue;
                 }
+                delete_keys.push_back(iter->key().ToString());
+                put_keys.push_back(std::move(key));
+                put_values.push_back(std::move(value));
             }
+            return iter->status().ok() ? 0 : -1;
+        };
+        ret = rekey(DiscoveryConstants::SCHEMA_IDENTIFY + DiscoveryConstants::NAMESPACE_SCHEMA_IDENTIFY,
+                    [](const std::string &value, std::string *key) {
+                        EA::discovery::NameSpaceInfo info;
+                        if (!info.ParseFromString(value)) {
+                            return false;
+                        }
+                        *key = NamespaceManager::construct_namespace_key(info.namespace_id());
+                        return true;
+                    });
+        ret = ret == 0 ? rekey(DiscoveryConstants::SCHEMA_IDENTIFY + DiscoveryConstants::ZONE_SCHEMA_IDENTIFY,
+                               [](const std::string &value, std::string *key) {
+                                   EA::discovery::ZoneInfo info;
+                                   if (!info.ParseFromString(value)) {
+                                       return false;
+                                   }
+                                   *key = ZoneManager::construct_zone_key(info.zone_id());
+                                   return true;
+                               }) : ret;
+        ret = ret == 0 ? rekey(DiscoveryConstants::SCHEMA_IDENTIFY + DiscoveryConstants::SERVLET_SCHEMA_IDENTIFY,
+                               [](const std::string &value, std::string *key) {
+                                   EA::discovery::ServletInfo info;
+                                   if (!info.ParseFromString(value)) {
+                                       return false;
+                                   }
+                                   *key = ServletManager::construct_servlet_key(info.servlet_id());
+                                   return true;
+                               }) : ret;
+        ret = ret == 0 ? rekey(DiscoveryConstants::CONFIG_IDENTIFY,
+                               [](const std::string &value, std::string *key) {
+                                   EA::discovery::ConfigInfo info;
+                                   if (!info.ParseFromString(value)) {
+                                       return false;
+                                   }
+                                   turbo::ModuleVersion version(info.version().major(), info.version().minor(),
+                                                                info.version().patch());
+                                   *key = ConfigManager::make_config_key(info.name(), version);
+                                   return true;
+                               }) : ret;
+        if (ret != 0) {
+            return -1;
         }
-        set_have_data(true);
+        /// an old key may be the new key of another record, it is not deleted then
+        std::set<std::string> new_keys(put_keys.begin(), put_keys.end());
+        delete_keys.erase(std::remove_if(delete_keys.begin(), delete_keys.end(),
+                                         [&new_keys](const std::string &key) { return new_keys.count(key) > 0; }),
+                          delete_keys.end());
+        put_keys.push_back(DiscoveryConstants::META_FORMAT_VERSION_KEY);
+        std::string version_stamp;
+        KeyEncoder::append_u64(version_stamp, DiscoveryConstants::META_FORMAT_VERSION);
+        put_values.push_back(version_stamp);
+        if (DiscoveryRocksdb::get_instance()->write_discovery_info(put_keys, put_values, delete_keys) != 0) {
+            TLOG_ERROR("write meta info fail when migrate from format version {}", version);
+            return -1;
+        }
+        /// the stamp alone is written too, dropped from the dirty keys it would never reach a snapshot
+        *migrated = true;
+        TLOG_WARN("migrate meta info from format version {} to {}, {} records, {} rewritten", version,
+                  DiscoveryConstants::META_FORMAT_VERSION, record_count, put_keys.size() - 1);
         return 0;
     }
 
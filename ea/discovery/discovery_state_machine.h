@@ -16,11 +16,15 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <set>
 #include <rocksdb/db.h>
 #include "ea/discovery/base_state_machine.h"
 #include "eapi/discovery/discovery.interface.pb.h"
 #include "ea/flags/discovery.h"
 #include "ea/discovery/discovery_constants.h"
+#include "ea/discovery/meta_kv.h"
 
 namespace EA::discovery {
 
@@ -47,11 +51,61 @@ namespace EA::discovery {
         int64_t applied_index() { return _applied_index; }
 
     private:
+        /// a snapshot is a base sst of all the keys, followed by delta ssts of the keys changed
+        /// since the previous snapshot, files are named by the applied index they were saved at
+        struct SnapshotFile {
+            std::string name;
+            std::string checksum;
+            int64_t index{0};
+            uint64_t size{0};
+            bool is_delta{false};
+        };
+
         void save_snapshot(braft::Closure *done,
-                           rocksdb::Iterator *iter,
+                           const std::shared_ptr<MetaKVSnapshot> &snapshot,
+                           int64_t index,
+                           const std::shared_ptr<std::set<std::string>> &dirty_keys,
                            braft::SnapshotWriter *writer);
 
+        int do_save_snapshot(MetaKVSnapshot *snapshot,
+                             int64_t index,
+                             const std::set<std::string> &dirty_keys,
+                             braft::SnapshotWriter *writer);
+
+        /// saves the whole MemoryMetaKV in one file
+        void save_memory_snapshot(braft::Closure *done,
+                                  const std::shared_ptr<MetaKVSnapshot> &snapshot,
+                                  int64_t index,
+                                  braft::SnapshotWriter *writer);
+
+        int load_memory_snapshot(braft::SnapshotReader *reader, const std::vector<std::string> &names);
+
+        /// one pass over the keys, each manager takes the keys of its own prefix in the key order
+        int load_managers(rocksdb::Iterator *iter);
+
+        /// re-keys the meta info loaded from a snapshot of an older key encoding, once, before the managers
+        /// load it. the keys are rebuilt from the values and written in one batch with the format version.
+        /// \param migrated set if anything was written, the files of the snapshot loaded are stale then
+        int migrate_meta_format(bool *migrated);
+
+        int write_base_file(MetaKVSnapshot *snapshot, const std::string &snapshot_path, SnapshotFile *file);
+
+        int write_delta_file(MetaKVSnapshot *snapshot,
+                             const std::set<std::string> &keys,
+                             const std::string &snapshot_path,
+                             SnapshotFile *file);
+
+        /// hard links the files of the last snapshot into the snapshot being saved
+        int link_snapshot_files(const std::vector<SnapshotFile> &files, const std::string &snapshot_path);
+
+        static bool parse_snapshot_file(const std::string &name, SnapshotFile *file);
+
+        static int file_checksum(const std::string &path, std::string *checksum);
+
         int64_t _applied_index = 0;
+        std::mutex _snapshot_mutex;
+        /// files of the last snapshot saved or loaded, base first
+        std::vector<SnapshotFile> _snapshot_files;
     };
 
 }  // namespace EA::discovery
@@ -19,7 +19,8 @@
 
 namespace EA::discovery {
 
-    void InstanceManager::add_instance(const EA::discovery::DiscoveryManagerRequest &request, braft::Closure *done) {
+    void InstanceManager::add_instance(const EA::discovery::DiscoveryManagerRequest &request, const int64_t apply_index,
+                                      braft::Closure *done) {
         auto &instance_info = const_cast<EA::discovery::ServletInstance &>(request.instance_info());
         const std::string &address = instance_info.address();
 
@@ -67,11 +68,13 @@ namespace EA::discovery {
         // update values in memory
         BAIDU_SCOPED_LOCK(_instance_mutex);
         set_instance_info(instance_info);
+        put_incremental_instance(apply_index, EA::discovery::OP_ADD_INSTANCE, instance_info);
         IF_DONE_SET_RESPONSE(done, EA::discovery::SUCCESS, "success");
         TLOG_INFO("create instance success, request:{}", request.ShortDebugString());
     }
 
-    void InstanceManager::drop_instance(const EA::discovery::DiscoveryManagerRequest &request, braft::Closure *done) {
+    void InstanceManager::drop_instance(const EA::discovery::DiscoveryManagerRequest &request, const int64_t apply_index,
+                                      braft::Closure *done) {
         auto &instance_info = request.instance_info();
         std::string address = instance_info.address();
         if (_instance_info.find(address) == _instance_info.end()) {
@@ -88,12 +91,16 @@ namespace EA::discovery {
             return;
         }
 
+        BAIDU_SCOPED_LOCK(_instance_mutex);
+        auto removed_pb = _instance_info[address];
         remove_instance_info(address);
+        put_incremental_instance(apply_index, EA::discovery::OP_DROP_INSTANCE, removed_pb);
         IF_DONE_SET_RESPONSE(done, EA::discovery::SUCCESS, "success");
         TLOG_INFO("drop instance success, request:{}", request.ShortDebugString());
     }
 
-    void InstanceManager::update_instance(const EA::discovery::DiscoveryManagerRequest &request, braft::Closure *done) {
+    void InstanceManager::update_instance(const EA::discovery::DiscoveryManagerRequest &request, const int64_t apply_index,
+                                      braft::Closure *done) {
         auto &instance_info = request.instance_info();
         std::string address = instance_info.address();
         if (_instance_info.find(address) == _instance_info.end()) {
@@ -135,8 +142,9 @@ namespace EA::discovery {
 
         BAIDU_SCOPED_LOCK(_instance_mutex);
         set_instance_info(tmp_instance_pb);
+        put_incremental_instance(apply_index, EA::discovery::OP_UPDATE_INSTANCE, tmp_instance_pb);
         IF_DONE_SET_RESPONSE(done, EA::discovery::SUCCESS, "success");
-        TLOG_INFO("drop instance success, request:{}", request.ShortDebugString());
+        TLOG_INFO("update instance success, request:{}", request.ShortDebugString());
     }
 
     int InstanceManager::load_instance_snapshot(const std::string &value) {
@@ -172,31 +180,47 @@ namespace EA::discovery {
     }
 
     void InstanceManager::remove_instance_info(const std::string &address) {
-        BAIDU_SCOPED_LOCK(_instance_mutex);
         auto &info = _instance_info[address];
         _removed_instance[address] = TimeCost();
-        _namespace_instance.erase(info.namespace_name());
+        auto erase_address = [&address](turbo::flat_hash_map<std::string, turbo::flat_hash_set<std::string>> &index,
+                                        const std::string &key) {
+            auto it = index.find(key);
+            if (it == index.end()) {
+                return;
+            }
+            it->second.erase(address);
+            if (it->second.empty()) {
+                index.erase(it);
+            }
+        };
+        erase_address(_namespace_instance, info.namespace_name());
         auto zone_key = ZoneManager::make_zone_key(info.namespace_name(), info.zone_name());
-        _zone_instance.erase(zone_key);
+        erase_address(_zone_instance, zone_key);
         auto servlet_key = ServletManager::make_servlet_key(zone_key, info.servlet_name());
-        _servlet_instance.erase(servlet_key);
+        erase_address(_servlet_instance, servlet_key);
         _instance_info.erase(address);
+    }
 
+    void InstanceManager::put_incremental_instance(const int64_t apply_index, EA::discovery::OpType op_type,
+                                                   const EA::discovery::ServletInstance &instance_info) {
+        InstanceIncremental incremental{op_type, instance_info};
+        _incremental_instance.put_incremental_info(apply_index, incremental);
+        _last_instance_index = apply_index;
+        bthread_cond_broadcast(&_instance_cond);
     }
 
-    int InstanceManager::load_snapshot() {
+    int InstanceManager::load_snapshot(rocksdb::Iterator *iter, const int64_t applied_index) {
         BAIDU_SCOPED_LOCK( InstanceManager::get_instance()->_instance_mutex);
         TLOG_INFO("start to load instance snapshot");
         clear();
+        /// the change log is gone with the old state, watchers behind this index need a full update
+        _last_instance_index = applied_index;
+        bthread_cond_broadcast(&_instance_cond);
         std::string config_prefix = DiscoveryConstants::DISCOVERY_IDENTIFY;
-        rocksdb::ReadOptions read_options;
-        read_options.prefix_same_as_start = true;
-        read_options.total_order_seek = false;
-        RocksStorage *db = RocksStorage::get_instance();
-        std::unique_ptr<rocksdb::Iterator> iter(
-                db->new_iterator(read_options, db->get_meta_info_handle()));
-        iter->Seek(config_prefix);
-        for (; iter->Valid(); iter->Next()) {
+        if (iter->Valid() && iter->key().compare(config_prefix) < 0) {
+            iter->Seek(config_prefix);
+        }
+        for (; iter->Valid() && iter->key().starts_with(config_prefix); iter->Next()) {
             if(load_instance_snapshot(iter->value().ToString()) != 0) {
                 return -1;
             }
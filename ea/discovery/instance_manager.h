@@ -23,15 +23,23 @@
 #include "turbo/container/flat_hash_set.h"
 #include "eapi/discovery/discovery.interface.pb.h"
 #include "braft/raft.h"
+#include "rocksdb/iterator.h"
 #include "bthread/mutex.h"
 #include "ea/discovery/discovery_constants.h"
 #include "turbo/times/stop_watcher.h"
 #include "ea/base/time_cast.h"
 #include "ea/discovery/zone_manager.h"
 #include "ea/discovery/servlet_manager.h"
+#include "ea/base/double_buffer.h"
 
 namespace EA::discovery {
 
+    /// one instance change recorded by the apply index of the raft log
+    struct InstanceIncremental {
+        EA::discovery::OpType op_type;
+        EA::discovery::ServletInstance instance;
+    };
+
     class InstanceManager {
     public:
         static InstanceManager *get_instance() {
@@ -43,18 +51,21 @@ namespace EA::discovery {
 
         ///
         /// \param request
+        /// \param apply_index
         /// \param done
-        void add_instance(const EA::discovery::DiscoveryManagerRequest &request, braft::Closure *done);
+        void add_instance(const EA::discovery::DiscoveryManagerRequest &request, const int64_t apply_index, braft::Closure *done);
 
         ///
         /// \param request
+        /// \param apply_index
         /// \param done
-        void drop_instance(const EA::discovery::DiscoveryManagerRequest &request, braft::Closure *done);
+        void drop_instance(const EA::discovery::DiscoveryManagerRequest &request, const int64_t apply_index, braft::Closure *done);
 
         ///
         /// \param request
+        /// \param apply_index
         /// \param done
-        void update_instance(const EA::discovery::DiscoveryManagerRequest &request, braft::Closure *done);
+        void update_instance(const EA::discovery::DiscoveryManagerRequest &request, const int64_t apply_index, braft::Closure *done);
 
         ///
         /// \param value
@@ -64,8 +75,11 @@ namespace EA::discovery {
         void clear();
 
         ///
+        /// \param iter shared by the managers loading a snapshot in one pass, it is left at the first
+        ///        key after the instance keys
+        /// \param applied_index raft index the snapshot was taken at
         /// \return
-        int load_snapshot();
+        int load_snapshot(rocksdb::Iterator *iter, const int64_t applied_index);
 
     private:
         InstanceManager();
@@ -76,9 +90,18 @@ namespace EA::discovery {
 
         void remove_instance_info(const std::string &address);
 
+        /// must be called with _instance_mutex held
+        void put_incremental_instance(const int64_t apply_index, EA::discovery::OpType op_type,
+                                      const EA::discovery::ServletInstance &instance_info);
+
     private:
         friend class QueryInstanceManager;
         bthread_mutex_t _instance_mutex;
+        /// signaled with _instance_mutex held whenever an instance change is applied
+        bthread_cond_t  _instance_cond;
+        /// apply index of the latest instance change, watchers wait until it passes theirs
+        int64_t         _last_instance_index{0};
+        IncrementalUpdate<InstanceIncremental>                                _incremental_instance;
         turbo::flat_hash_map<std::string, EA::discovery::ServletInstance>       _instance_info;
         turbo::flat_hash_map<std::string, TimeCost>                           _removed_instance;
 
@@ -94,9 +117,11 @@ namespace EA::discovery {
 
     inline InstanceManager::InstanceManager() {
         bthread_mutex_init(&_instance_mutex, nullptr);
+        bthread_cond_init(&_instance_cond, nullptr);
     }
 
     inline InstanceManager::~InstanceManager() {
+        bthread_cond_destroy(&_instance_cond);
         bthread_mutex_destroy(&_instance_mutex);
     }
 
@@ -113,6 +138,7 @@ namespace EA::discovery {
         _namespace_instance.clear();
         _zone_instance.clear();
         _servlet_instance.clear();
+        _incremental_instance.clear();
     }
 
 }  // namespace EA::discovery
@@ -0,0 +1,66 @@
+// Copyright 2023 The Elastic AI Search Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace EA::discovery {
+
+    /// order preserving encoding of the meta info keys, the bytewise order of the encoded keys is the
+    /// order of the values encoded. the integers are big endian, the signed ones with the sign bit flipped,
+    /// the strings inside a key are prefixed by their length so a name is never a prefix of another one.
+    struct KeyEncoder {
+        static void append_u32(std::string &key, uint32_t value) {
+            char buf[4];
+            for (int i = 3; i >= 0; --i) {
+                buf[i] = static_cast<char>(value & 0xFF);
+                value >>= 8;
+            }
+            key.append(buf, sizeof(buf));
+        }
+
+        static void append_u64(std::string &key, uint64_t value) {
+            char buf[8];
+            for (int i = 7; i >= 0; --i) {
+                buf[i] = static_cast<char>(value & 0xFF);
+                value >>= 8;
+            }
+            key.append(buf, sizeof(buf));
+        }
+
+        static void append_i64(std::string &key, int64_t value) {
+            append_u64(key, static_cast<uint64_t>(value) ^ (1ULL << 63));
+        }
+
+        static void append_string(std::string &key, std::string_view value) {
+            append_u32(key, static_cast<uint32_t>(value.size()));
+            key.append(value.data(), value.size());
+        }
+
+        /// reads the u64 written by append_u64 at the front of data, data holds 8 bytes at least
+        static uint64_t decode_u64(std::string_view data) {
+            uint64_t value = 0;
+            for (size_t i = 0; i < sizeof(value); ++i) {
+                value = (value << 8) | static_cast<uint8_t>(data[i]);
+            }
+            return value;
+        }
+    };
+
+}  // namespace EA::discovery
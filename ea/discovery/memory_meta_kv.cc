@@ -0,0 +1,301 @@
+// Copyright 2023 The Elastic AI Search Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "ea/discovery/memory_meta_kv.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <butil/crc32c.h>
+#include <butil/errno.h>
+#include "ea/base/tlog.h"
+
+namespace EA::discovery {
+
+    static const char kMetaStoreMagic[8] = {'E', 'A', 'M', 'E', 'T', 'A', '0', '1'};
+    static const size_t kTrailerSize = sizeof(uint64_t) + sizeof(uint32_t);
+    static const size_t kChunkSize = 64 * 1024;
+
+    /// iterates the keys of the map starting with the prefix, the map is kept by the iterator
+    class MemoryMetaIterator : public rocksdb::Iterator {
+    public:
+        MemoryMetaIterator(const std::shared_ptr<const MemoryMetaKV::KVMap> &data, const std::string &prefix)
+                : _data(data), _prefix(prefix), _it(data->end()) {}
+
+        bool Valid() const override {
+            return _it != _data->end() && _it->first.compare(0, _prefix.size(), _prefix) == 0;
+        }
+
+        void SeekToFirst() override {
+            _it = _data->lower_bound(_prefix);
+        }
+
+        void SeekToLast() override {
+            auto it = _prefix.empty() ? _data->end() : _data->lower_bound(prefix_end());
+            _it = it == _data->begin() ? _data->end() : std::prev(it);
+        }
+
+        void Seek(const rocksdb::Slice &target) override {
+            auto key = target.ToString();
+            _it = _data->lower_bound(key < _prefix ? _prefix : key);
+        }
+
+        void SeekForPrev(const rocksdb::Slice &target) override {
+            auto it = _data->upper_bound(target.ToString());
+            _it = it == _data->begin() ? _data->end() : std::prev(it);
+        }
+
+        void Next() override {
+            ++_it;
+        }
+
+        void Prev() override {
+            _it = _it == _data->begin() ? _data->end() : std::prev(_it);
+        }
+
+        rocksdb::Slice key() const override {
+            return _it->first;
+        }
+
+        rocksdb::Slice value() const override {
+            return _it->second;
+        }
+
+        rocksdb::Status status() const override {
+            return rocksdb::Status::OK();
+        }
+
+    private:
+        /// the first key after all the keys starting with the prefix
+        std::string prefix_end() const {
+            std::string end = _prefix;
+            while (!end.empty() && static_cast<uint8_t>(end.back()) == 0xff) {
+                end.pop_back();
+            }
+            if (!end.empty()) {
+                end.back() = static_cast<char>(static_cast<uint8_t>(end.back()) + 1);
+            }
+            return end;
+        }
+
+        std::shared_ptr<const MemoryMetaKV::KVMap> _data;
+        std::string _prefix;
+        MemoryMetaKV::KVMap::const_iterator _it;
+    };
+
+    class MemoryMetaKVSnapshot : public MetaKVSnapshot {
+    public:
+        explicit MemoryMetaKVSnapshot(const std::shared_ptr<const MemoryMetaKV::KVMap> &data) : _data(data) {}
+
+        int get(const std::string &key, std::string *value) override {
+            auto it = _data->find(key);
+            if (it == _data->end()) {
+                return 1;
+            }
+            *value = it->second;
+            return 0;
+        }
+
+        rocksdb::Iterator *new_iterator(const std::string &prefix) override {
+            return new MemoryMetaIterator(_data, prefix);
+        }
+
+    private:
+        std::shared_ptr<const MemoryMetaKV::KVMap> _data;
+    };
+
+    int MemoryMetaKV::write(const std::vector<std::string> &put_keys,
+                            const std::vector<std::string> &put_values,
+                            const std::vector<std::string> &delete_keys) {
+        if (put_keys.size() != put_values.size()) {
+            TLOG_WARN("input keys'size is not equal to values' size");
+            return -1;
+        }
+        std::unique_lock lock(_mutex);
+        if (_data.use_count() > 1) {
+            /// a snapshot or an iterator is held, it keeps the map it took
+            _data = std::make_shared<KVMap>(*_data);
+        }
+        for (size_t i = 0; i < put_keys.size(); ++i) {
+            (*_data)[put_keys[i]] = put_values[i];
+        }
+        for (auto &key: delete_keys) {
+            _data->erase(key);
+        }
+        return 0;
+    }
+
+    int MemoryMetaKV::get(const std::string &key, std::string *value) {
+        std::unique_lock lock(_mutex);
+        auto it = _data->find(key);
+        if (it == _data->end()) {
+            return 1;
+        }
+        *value = it->second;
+        return 0;
+    }
+
+    rocksdb::Iterator *MemoryMetaKV::new_iterator(const std::string &prefix) {
+        return new MemoryMetaIterator(data(), prefix);
+    }
+
+    std::shared_ptr<MetaKVSnapshot> MemoryMetaKV::snapshot() {
+        return std::make_shared<MemoryMetaKVSnapshot>(data());
+    }
+
+    std::shared_ptr<const MemoryMetaKV::KVMap> MemoryMetaKV::data() {
+        std::unique_lock lock(_mutex);
+        return _data;
+    }
+
+    static bool write_all(int fd, const char *data, size_t size) {
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                return false;
+            }
+            data += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    int MemoryMetaKV::save(const std::shared_ptr<MetaKVSnapshot> &snapshot, const std::string &path,
+                           int64_t *count, uint64_t *size) {
+        int fd = ::open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+        if (fd < 0) {
+            TLOG_WARN("create meta store file {} fail:{}", path, berror());
+            return -1;
+        }
+        /// the records are written by chunks, the crc runs over what is written
+        uint32_t crc = 0;
+        uint64_t file_size = 0;
+        std::string buf(kMetaStoreMagic, sizeof(kMetaStoreMagic));
+        buf.reserve(kChunkSize * 2);
+        auto flush = [&]() {
+            crc = butil::crc32c::Extend(crc, buf.data(), buf.size());
+            file_size += buf.size();
+            bool ok = write_all(fd, buf.data(), buf.size());
+            buf.clear();
+            return ok;
+        };
+        bool ok = true;
+        uint64_t key_count = 0;
+        std::unique_ptr<rocksdb::Iterator> iter(snapshot->new_iterator(""));
+        for (iter->SeekToFirst(); ok && iter->Valid(); iter->Next()) {
+            uint32_t key_size = iter->key().size();
+            uint32_t value_size = iter->value().size();
+            buf.append(reinterpret_cast<const char *>(&key_size), sizeof(key_size));
+            buf.append(reinterpret_cast<const char *>(&value_size), sizeof(value_size));
+            buf.append(iter->key().data(), key_size);
+            buf.append(iter->value().data(), value_size);
+            ++key_count;
+            if (buf.size() >= kChunkSize) {
+                ok = flush();
+            }
+        }
+        buf.append(reinterpret_cast<const char *>(&key_count), sizeof(key_count));
+        ok = ok && flush();
+        buf.append(reinterpret_cast<const char *>(&crc), sizeof(crc));
+        file_size += buf.size();
+        ok = ok && write_all(fd, buf.data(), buf.size());
+        if (!ok) {
+            TLOG_WARN("write meta store file {} fail:{}", path, berror());
+            ::close(fd);
+            return -1;
+        }
+        if (::fdatasync(fd) != 0) {
+            TLOG_WARN("sync meta store file {} fail:{}", path, berror());
+            ::close(fd);
+            return -1;
+        }
+        ::close(fd);
+        *count = key_count;
+        *size = file_size;
+        return 0;
+    }
+
+    int MemoryMetaKV::load(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            TLOG_WARN("open meta store file {} fail:{}", path, berror());
+            return -1;
+        }
+        std::string buf;
+        char chunk[kChunkSize];
+        while (true) {
+            ssize_t n = ::read(fd, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                TLOG_WARN("read meta store file {} fail:{}", path, berror());
+                ::close(fd);
+                return -1;
+            }
+            if (n == 0) {
+                break;
+            }
+            buf.append(chunk, n);
+        }
+        ::close(fd);
+        if (buf.size() < sizeof(kMetaStoreMagic) + kTrailerSize ||
+            memcmp(buf.data(), kMetaStoreMagic, sizeof(kMetaStoreMagic)) != 0) {
+            TLOG_ERROR("meta store file {} has a bad header", path);
+            return -1;
+        }
+        uint32_t crc;
+        uint64_t count;
+        size_t body_end = buf.size() - kTrailerSize;
+        memcpy(&count, buf.data() + body_end, sizeof(count));
+        memcpy(&crc, buf.data() + body_end + sizeof(count), sizeof(crc));
+        if (butil::crc32c::Value(buf.data(), buf.size() - sizeof(crc)) != crc) {
+            TLOG_ERROR("meta store file {} is corrupted", path);
+            return -1;
+        }
+        auto data = std::make_shared<KVMap>();
+        size_t offset = sizeof(kMetaStoreMagic);
+        while (offset < body_end) {
+            uint32_t key_size;
+            uint32_t value_size;
+            if (offset + sizeof(key_size) + sizeof(value_size) > body_end) {
+                break;
+            }
+            memcpy(&key_size, buf.data() + offset, sizeof(key_size));
+            memcpy(&value_size, buf.data() + offset + sizeof(key_size), sizeof(value_size));
+            offset += sizeof(key_size) + sizeof(value_size);
+            if (offset + key_size + value_size > body_end) {
+                break;
+            }
+            /// saved in the key order, appended at the end of the map
+            data->emplace_hint(data->end(), std::string(buf.data() + offset, key_size),
+                               std::string(buf.data() + offset + key_size, value_size));
+            offset += key_size + value_size;
+        }
+        if (offset != body_end || data->size() != count) {
+            TLOG_ERROR("meta store file {} has {} keys, expect {}", path, data->size(), count);
+            return -1;
+        }
+        std::unique_lock lock(_mutex);
+        _data = data;
+        TLOG_INFO("load meta store file {}, keys:{}, bytes:{}", path, count, buf.size());
+        return 0;
+    }
+
+}  // namespace EA::discovery
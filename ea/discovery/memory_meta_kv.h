@@ -0,0 +1,71 @@
+// Copyright 2023 The Elastic AI Search Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ea/discovery/meta_kv.h"
+
+namespace EA::discovery {
+
+    /// keeps the discovery meta info in an ordered map instead of rocksdb, selected by
+    /// FLAGS_discovery_meta_store=memory. the raft log is the durability, a raft snapshot is
+    /// the whole map in one binary file, loaded back at start and followed by the log replay.
+    /// a snapshot of the map is taken in O(1), the next write copies the map if the snapshot
+    /// is still held, so the apply thread is never blocked by the file being written.
+    class MemoryMetaKV : public MetaKV {
+    public:
+        typedef std::map<std::string, std::string> KVMap;
+
+        MemoryMetaKV() : _data(std::make_shared<KVMap>()) {}
+
+        const char *name() const override {
+            return "memory";
+        }
+
+        int init() override {
+            return 0;
+        }
+
+        int write(const std::vector<std::string> &put_keys,
+                  const std::vector<std::string> &put_values,
+                  const std::vector<std::string> &delete_keys) override;
+
+        int get(const std::string &key, std::string *value) override;
+
+        rocksdb::Iterator *new_iterator(const std::string &prefix) override;
+
+        std::shared_ptr<MetaKVSnapshot> snapshot() override;
+
+        /// replaces the map with the one saved in the file
+        int load(const std::string &path);
+
+        /// the file is [magic(8)] ([key size(4)][value size(4)][key][value])* [count(8)][crc32c(4)]
+        int save(const std::shared_ptr<MetaKVSnapshot> &snapshot, const std::string &path,
+                 int64_t *count, uint64_t *size);
+
+    private:
+        std::shared_ptr<const KVMap> data();
+
+        std::mutex _mutex;
+        std::shared_ptr<KVMap> _data;
+    };
+
+}  // namespace EA::discovery
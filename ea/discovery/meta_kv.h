@@ -0,0 +1,79 @@
+// Copyright 2023 The Elastic AI Search Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <rocksdb/iterator.h>
+
+namespace EA::discovery {
+
+    /// a consistent view of a MetaKV, the writes after it was taken are not seen
+    class MetaKVSnapshot {
+    public:
+        virtual ~MetaKVSnapshot() = default;
+
+        /// \return 0 if the key is found, 1 if it is not, -1 on error
+        virtual int get(const std::string &key, std::string *value) = 0;
+
+        /// iterates the keys starting with the prefix in the key order, all the keys if it is empty.
+        /// the iterator may outlive the snapshot
+        virtual rocksdb::Iterator *new_iterator(const std::string &prefix) = 0;
+    };
+
+    /// the ordered key value store of the discovery meta info, written by the managers through
+    /// DiscoveryRocksdb on the apply thread, selected by FLAGS_discovery_meta_store.
+    class MetaKV {
+    public:
+        virtual ~MetaKV() = default;
+
+        virtual const char *name() const = 0;
+
+        virtual int init() = 0;
+
+        /// puts and deletes the keys in one atomic batch
+        virtual int write(const std::vector<std::string> &put_keys,
+                          const std::vector<std::string> &put_values,
+                          const std::vector<std::string> &delete_keys) = 0;
+
+        /// \return 0 if the key is found, 1 if it is not, -1 on error
+        virtual int get(const std::string &key, std::string *value) = 0;
+
+        /// iterates the latest keys starting with the prefix, all the keys if it is empty
+        virtual rocksdb::Iterator *new_iterator(const std::string &prefix) = 0;
+
+        virtual std::shared_ptr<MetaKVSnapshot> snapshot() = 0;
+
+        /// persists what is buffered in memory, the raft log covers it meanwhile
+        virtual void flush() {}
+
+        /// the writes are stalled by the store, the admission controller slows down
+        virtual bool is_stall() {
+            return false;
+        }
+
+        int put(const std::string &key, const std::string &value) {
+            return write({key}, {value}, {});
+        }
+
+        int remove(const std::vector<std::string> &keys) {
+            return write({}, {}, keys);
+        }
+    };
+
+}  // namespace EA::discovery
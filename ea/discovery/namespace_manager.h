@@ -21,6 +21,7 @@
 #include <mutex>
 #include "eapi/discovery/discovery.interface.pb.h"
 #include "ea/discovery/discovery_constants.h"
+#include "ea/discovery/key_encoder.h"
 #include "braft/raft.h"
 #include "bthread/mutex.h"
 
@@ -111,6 +112,12 @@ namespace EA::discovery {
         /// \brief clear memory values.
         void clear();
 
+        ///
+        /// \brief construct namespace key
+        /// \param namespace_id
+        /// \return order preserving, big endian with the sign bit flipped
+        static std::string construct_namespace_key(int64_t namespace_id);
+
     private:
         NamespaceManager();
 
@@ -124,12 +131,6 @@ namespace EA::discovery {
         /// \param namespace_name
         void erase_namespace_info(const std::string &namespace_name);
 
-        ///
-        /// \brief construct namespace key
-        /// \param namespace_id
-        /// \return
-        std::string construct_namespace_key(int64_t namespace_id);
-
         std::string construct_max_namespace_id_key();
 
     private:
@@ -222,7 +223,7 @@ namespace EA::discovery {
     inline std::string NamespaceManager::construct_namespace_key(int64_t namespace_id) {
         std::string namespace_key = DiscoveryConstants::SCHEMA_IDENTIFY
                                     + DiscoveryConstants::NAMESPACE_SCHEMA_IDENTIFY;
-        namespace_key.append((char *) &namespace_id, sizeof(int64_t));
+        KeyEncoder::append_i64(namespace_key, namespace_id);
         return namespace_key;
     }
 
@@ -237,17 +237,13 @@ namespace EA::discovery {
     }
 
 
-    int PrivilegeManager::load_snapshot() {
+    int PrivilegeManager::load_snapshot(rocksdb::Iterator *iter) {
         _user_privilege.clear();
         std::string privilege_prefix = DiscoveryConstants::PRIVILEGE_IDENTIFY;
-        rocksdb::ReadOptions read_options;
-        read_options.prefix_same_as_start = true;
-        read_options.total_order_seek = false;
-        RocksStorage *db = RocksStorage::get_instance();
-        std::unique_ptr<rocksdb::Iterator> iter(
-                db->new_iterator(read_options, db->get_meta_info_handle()));
-        iter->Seek(privilege_prefix);
-        for (; iter->Valid(); iter->Next()) {
+        if (iter->Valid() && iter->key().compare(privilege_prefix) < 0) {
+            iter->Seek(privilege_prefix);
+        }
+        for (; iter->Valid() && iter->key().starts_with(privilege_prefix); iter->Next()) {
             std::string username(iter->key().ToString(), privilege_prefix.size());
             EA::discovery::UserPrivilege user_privilege;
             if (!user_privilege.ParseFromString(iter->value().ToString())) {
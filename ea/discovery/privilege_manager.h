@@ -74,8 +74,10 @@ namespace EA::discovery {
         void drop_privilege(const EA::discovery::DiscoveryManagerRequest &request, braft::Closure *done);
 
         ///
+        /// \param iter shared by the managers loading a snapshot in one pass, it is left at the first
+        ///        key after the privilege keys
         /// \return
-        int load_snapshot();
+        int load_snapshot(rocksdb::Iterator *iter);
 
         ///
         /// \param discovery_state_machine
@@ -14,6 +14,8 @@
 
 #include "ea/discovery/query_config_manager.h"
 #include "ea/discovery/config_manager.h"
+#include "ea/flags/discovery.h"
+#include "ea/base/time_cast.h"
 
 namespace EA::discovery {
 
@@ -25,7 +27,7 @@ namespace EA::discovery {
             return;
         }
         BAIDU_SCOPED_LOCK( ConfigManager::get_instance()->_config_mutex);
-        auto configs = ConfigManager::get_instance()->_configs;
+        auto &configs = ConfigManager::get_instance()->_configs;
         auto &name = request->config_name();
         auto it = configs.find(name);
         if (it == configs.end() || it->second.empty()) {
@@ -39,6 +41,17 @@ namespace EA::discovery {
             // use newest
             // version = it->second.rend()->first;
             auto cit = it->second.rbegin();
+            if (request->has_known_version()) {
+                turbo::ModuleVersion known_version(request->known_version().major(), request->known_version().minor(),
+                                                   request->known_version().patch());
+                if (!(known_version < cit->first)) {
+                    /// not modified, let the caller know the newest version without the content
+                    config_info_without_content(cit->first, cit->second, response->add_config_infos());
+                    response->set_errmsg("not modified");
+                    response->set_errcode(EA::discovery::SUCCESS);
+                    return;
+                }
+            }
             *(response->add_config_infos()) = cit->second;
             response->set_errmsg("success");
             response->set_errcode(EA::discovery::SUCCESS);
@@ -83,7 +96,7 @@ namespace EA::discovery {
         }
         auto &name = request->config_name();
         BAIDU_SCOPED_LOCK( ConfigManager::get_instance()->_config_mutex);
-        auto configs = ConfigManager::get_instance()->_configs;
+        auto &configs = ConfigManager::get_instance()->_configs;
         auto it = configs.find(name);
         if (it == configs.end()) {
             response->set_errmsg("config not exist");
@@ -92,10 +105,102 @@ namespace EA::discovery {
         }
         response->mutable_config_infos()->Reserve(it->second.size());
         for (auto vit = it->second.begin(); vit != it->second.end(); ++vit) {
-            *(response->add_config_infos()) = vit->second;
+            if (request->skip_content()) {
+                config_info_without_content(vit->first, vit->second, response->add_config_infos());
+            } else {
+                *(response->add_config_infos()) = vit->second;
+            }
+        }
+        response->set_errmsg("success");
+        response->set_errcode(EA::discovery::SUCCESS);
+    }
+
+    void QueryConfigManager::multi_get_config(const ::EA::discovery::DiscoveryQueryRequest *request,
+                                              ::EA::discovery::DiscoveryQueryResponse *response) {
+        if (request->config_infos_size() == 0) {
+            response->set_errmsg("no config to get");
+            response->set_errcode(EA::discovery::INPUT_PARAM_ERROR);
+            return;
+        }
+        auto manager = ConfigManager::get_instance();
+        response->mutable_config_infos()->Reserve(request->config_infos_size());
+        BAIDU_SCOPED_LOCK(manager->_config_mutex);
+        for (auto &get : request->config_infos()) {
+            auto it = manager->_configs.find(get.name());
+            if (it == manager->_configs.end() || it->second.empty()) {
+                response->clear_config_infos();
+                response->set_errmsg(turbo::Format("config {} not exist", get.name()));
+                response->set_errcode(EA::discovery::INPUT_PARAM_ERROR);
+                return;
+            }
+            if (!get.has_version()) {
+                *(response->add_config_infos()) = it->second.rbegin()->second;
+                continue;
+            }
+            turbo::ModuleVersion version(get.version().major(), get.version().minor(), get.version().patch());
+            auto cit = it->second.find(version);
+            if (cit == it->second.end()) {
+                response->clear_config_infos();
+                response->set_errmsg(turbo::Format("config {} version {} not exist", get.name(), version.to_string()));
+                response->set_errcode(EA::discovery::INPUT_PARAM_ERROR);
+                return;
+            }
+            *(response->add_config_infos()) = cit->second;
         }
         response->set_errmsg("success");
         response->set_errcode(EA::discovery::SUCCESS);
     }
 
+    void QueryConfigManager::watch_config(const ::EA::discovery::DiscoveryQueryRequest *request,
+                                          ::EA::discovery::DiscoveryQueryResponse *response) {
+        if (request->config_infos_size() == 0) {
+            response->set_errmsg("no config to watch");
+            response->set_errcode(EA::discovery::INPUT_PARAM_ERROR);
+            return;
+        }
+        auto manager = ConfigManager::get_instance();
+        const int64_t timeout_us = FLAGS_discovery_config_watch_timeout_ms * 1000LL;
+        TimeCost time_cost;
+        BAIDU_SCOPED_LOCK(manager->_config_mutex);
+        while (true) {
+            for (auto &watch : request->config_infos()) {
+                auto it = manager->_configs.find(watch.name());
+                if (it == manager->_configs.end() || it->second.empty()) {
+                    continue;
+                }
+                turbo::ModuleVersion known_version(watch.version().major(), watch.version().minor(),
+                                                   watch.version().patch());
+                auto newest = it->second.rbegin();
+                if (!(known_version < newest->first)) {
+                    continue;
+                }
+                config_info_without_content(newest->first, newest->second, response->add_config_infos());
+            }
+            if (response->config_infos_size() > 0) {
+                break;
+            }
+            int64_t left_us = timeout_us - time_cost.get_time();
+            if (left_us <= 0) {
+                break;
+            }
+            timespec abstime = butil::microseconds_from_now(left_us);
+            bthread_cond_timedwait(&manager->_config_cond, &manager->_config_mutex, &abstime);
+        }
+        response->set_errmsg("success");
+        response->set_errcode(EA::discovery::SUCCESS);
+    }
+
+    void QueryConfigManager::config_info_without_content(const turbo::ModuleVersion &version,
+                                                         const EA::discovery::ConfigInfo &config,
+                                                         EA::discovery::ConfigInfo *out) {
+        out->set_name(config.name());
+        out->mutable_version()->set_major(version.major);
+        out->mutable_version()->set_minor(version.minor);
+        out->mutable_version()->set_patch(version.patch);
+        out->set_type(config.type());
+        if (config.has_time()) {
+            out->set_time(config.time());
+        }
+    }
+
 }  // namespace EA::discovery
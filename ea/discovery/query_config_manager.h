@@ -17,6 +17,7 @@
 #define EA_DISCOVERY_QUERY_CONFIG_MANAGER_H_
 
 #include "eapi/discovery/discovery.interface.pb.h"
+#include "turbo/module/module_version.h"
 
 namespace EA::discovery {
 
@@ -44,6 +45,33 @@ namespace EA::discovery {
         /// \param response
         void list_config_version(const ::EA::discovery::DiscoveryQueryRequest *request,
                                  ::EA::discovery::DiscoveryQueryResponse *response);
+
+        ///
+        /// \brief get all the configs in request->config_infos() in one response, the newest version
+        ///        is used for the entries without version. fails if any of them not exists.
+        /// \param request
+        /// \param response
+        void multi_get_config(const ::EA::discovery::DiscoveryQueryRequest *request,
+                              ::EA::discovery::DiscoveryQueryResponse *response);
+
+        ///
+        /// \brief hold the request until one of the configs in request->config_infos() has a version
+        ///        newer than the one the caller knows, or FLAGS_discovery_config_watch_timeout_ms passed.
+        ///        changed configs are returned as name/version/type only, content is fetched by the caller.
+        /// \param request
+        /// \param response
+        void watch_config(const ::EA::discovery::DiscoveryQueryRequest *request,
+                          ::EA::discovery::DiscoveryQueryResponse *response);
+
+    private:
+        ///
+        /// \brief copy everything but content, the version is taken from the key of the config map
+        /// \param version
+        /// \param config
+        /// \param out
+        static void config_info_without_content(const turbo::ModuleVersion &version,
+                                                const EA::discovery::ConfigInfo &config,
+                                                EA::discovery::ConfigInfo *out);
     };
 }  // namespace EA::discovery
 
@@ -16,6 +16,7 @@
 // Created by jeff on 23-11-29.
 //
 #include "ea/discovery/query_instance_manager.h"
+#include "ea/flags/discovery.h"
 
 namespace EA::discovery {
 
@@ -110,6 +111,106 @@ namespace EA::discovery {
         response->set_errmsg("success");
     }
 
+    void QueryInstanceManager::watch_instance(const EA::discovery::DiscoveryQueryRequest *request, EA::discovery::DiscoveryQueryResponse *response) {
+        auto manager = InstanceManager::get_instance();
+        int64_t last_updated_index = request->last_updated_index();
+        const int64_t timeout_us = FLAGS_discovery_instance_watch_timeout_ms * 1000LL;
+        TimeCost time_cost;
+        /// address --> net change since last_updated_index
+        turbo::flat_hash_map<std::string, InstanceIncremental> changes;
+        auto merge_change = [&changes, request](const InstanceIncremental &incremental) {
+            if (!match_instance(request, incremental.instance)) {
+                return;
+            }
+            auto &address = incremental.instance.address();
+            auto it = changes.find(address);
+            if (it == changes.end()) {
+                changes[address] = incremental;
+                return;
+            }
+            auto prev_op = it->second.op_type;
+            if (incremental.op_type == EA::discovery::OP_DROP_INSTANCE) {
+                if (prev_op == EA::discovery::OP_ADD_INSTANCE) {
+                    // never seen by the watcher
+                    changes.erase(it);
+                } else {
+                    it->second = incremental;
+                }
+                return;
+            }
+            if (prev_op == EA::discovery::OP_DROP_INSTANCE) {
+                // dropped and added back, the watcher sees it as updated
+                it->second.op_type = EA::discovery::OP_UPDATE_INSTANCE;
+            } else if (prev_op == EA::discovery::OP_ADD_INSTANCE) {
+                it->second.op_type = EA::discovery::OP_ADD_INSTANCE;
+            } else {
+                it->second.op_type = incremental.op_type;
+            }
+            it->second.instance = incremental.instance;
+        };
+
+        bool full_update = false;
+        BAIDU_SCOPED_LOCK(manager->_instance_mutex);
+        while (true) {
+            if (manager->_last_instance_index > last_updated_index) {
+                full_update = manager->_incremental_instance.check_and_update_incremental(merge_change,
+                                                                                       last_updated_index,
+                                                                                       manager->_last_instance_index);
+                last_updated_index = manager->_last_instance_index;
+                if (full_update || !changes.empty()) {
+                    break;
+                }
+            }
+            int64_t left_us = timeout_us - time_cost.get_time();
+            if (left_us <= 0) {
+                break;
+            }
+            timespec abstime = butil::microseconds_from_now(left_us);
+            bthread_cond_timedwait(&manager->_instance_cond, &manager->_instance_mutex, &abstime);
+        }
+
+        if (full_update) {
+            for (auto &it : manager->_instance_info) {
+                if (!match_instance(request, it.second)) {
+                    continue;
+                }
+                EA::discovery::QueryInstance ins;
+                instance_info_to_query(it.second, ins);
+                *response->add_flatten_instances() = std::move(ins);
+            }
+        } else {
+            for (auto &it : changes) {
+                EA::discovery::QueryInstance ins;
+                instance_info_to_query(it.second.instance, ins);
+                if (it.second.op_type == EA::discovery::OP_ADD_INSTANCE) {
+                    *response->add_added_instances() = std::move(ins);
+                } else if (it.second.op_type == EA::discovery::OP_DROP_INSTANCE) {
+                    *response->add_removed_instances() = std::move(ins);
+                } else {
+                    *response->add_updated_instances() = std::move(ins);
+                }
+            }
+        }
+        response->set_is_full_update(full_update);
+        response->set_last_updated_index(last_updated_index);
+        response->set_errcode(EA::discovery::SUCCESS);
+        response->set_errmsg("success");
+    }
+
+    bool QueryInstanceManager::match_instance(const EA::discovery::DiscoveryQueryRequest *request,
+                                              const EA::discovery::ServletInstance &sinstance) {
+        if (!request->namespace_name().empty() && request->namespace_name() != sinstance.namespace_name()) {
+            return false;
+        }
+        if (!request->zone().empty() && request->zone() != sinstance.zone_name()) {
+            return false;
+        }
+        if (!request->servlet().empty() && request->servlet() != sinstance.servlet_name()) {
+            return false;
+        }
+        return true;
+    }
+
     void QueryInstanceManager::instance_info_to_query(const EA::discovery::ServletInstance &sinstance, EA::discovery::QueryInstance &ins) {
         ins.set_namespace_name(sinstance.namespace_name());
         ins.set_zone_name(sinstance.zone_name());
@@ -118,6 +219,7 @@ namespace EA::discovery {
         ins.set_color(sinstance.color());
         ins.set_version(sinstance.version());
         ins.set_status(sinstance.status());
+        ins.set_weight(sinstance.weight());
         ins.set_address(sinstance.address());
     }
 }  // namespace EA::discovery
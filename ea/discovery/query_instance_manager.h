@@ -42,8 +42,21 @@ namespace EA::discovery {
         /// \param response
         void query_instance_flatten(const EA::discovery::DiscoveryQueryRequest *request, EA::discovery::DiscoveryQueryResponse *response);
 
+        ///
+        /// \brief long poll for instance changes after request->last_updated_index, blocks until
+        ///        a matched change is applied or FLAGS_discovery_instance_watch_timeout_ms passed.
+        ///        the whole matched instance set is returned in flatten_instances with is_full_update
+        ///        set when the change log no longer covers the index of the caller.
+        /// \param request
+        /// \param response
+        void watch_instance(const EA::discovery::DiscoveryQueryRequest *request, EA::discovery::DiscoveryQueryResponse *response);
+
     public:
         static void instance_info_to_query(const EA::discovery::ServletInstance &sinstance, EA::discovery::QueryInstance &ins);
+
+    private:
+        static bool match_instance(const EA::discovery::DiscoveryQueryRequest *request,
+                                   const EA::discovery::ServletInstance &sinstance);
     };
 }  // namespace EA::discovery
 
@@ -0,0 +1,244 @@
+// Copyright 2023 The Elastic AI Search Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "ea/discovery/rocks_meta_kv.h"
+#include "ea/flags/discovery.h"
+#include "ea/base/tlog.h"
+
+namespace EA::discovery {
+
+    /// the first key after all the keys starting with the prefix, empty if there is none
+    static std::string prefix_end(const std::string &prefix) {
+        std::string end = prefix;
+        while (!end.empty() && static_cast<uint8_t>(end.back()) == 0xff) {
+            end.pop_back();
+        }
+        if (!end.empty()) {
+            end.back() = static_cast<char>(static_cast<uint8_t>(end.back()) + 1);
+        }
+        return end;
+    }
+
+    /// keeps the bounds the rocksdb iterator points to, and the snapshot it reads
+    class RocksPrefixIterator : public rocksdb::Iterator {
+    public:
+        RocksPrefixIterator(RocksStorage *rocksdb,
+                            rocksdb::ReadOptions read_options,
+                            const std::string &prefix,
+                            const std::shared_ptr<MetaKVSnapshot> &snapshot)
+                : _lower(prefix), _upper(prefix_end(prefix)), _snapshot(snapshot) {
+            read_options.prefix_same_as_start = false;
+            read_options.total_order_seek = true;
+            if (!_lower.empty()) {
+                _lower_bound = _lower;
+                read_options.iterate_lower_bound = &_lower_bound;
+            }
+            if (!_upper.empty()) {
+                _upper_bound = _upper;
+                read_options.iterate_upper_bound = &_upper_bound;
+            }
+            _iter.reset(rocksdb->new_iterator(read_options, rocksdb->get_meta_info_handle()));
+        }
+
+        bool Valid() const override {
+            return _iter->Valid();
+        }
+
+        void SeekToFirst() override {
+            _iter->SeekToFirst();
+        }
+
+        void SeekToLast() override {
+            _iter->SeekToLast();
+        }
+
+        void Seek(const rocksdb::Slice &target) override {
+            _iter->Seek(target);
+        }
+
+        void SeekForPrev(const rocksdb::Slice &target) override {
+            _iter->SeekForPrev(target);
+        }
+
+        void Next() override {
+            _iter->Next();
+        }
+
+        void Prev() override {
+            _iter->Prev();
+        }
+
+        rocksdb::Slice key() const override {
+            return _iter->key();
+        }
+
+        rocksdb::Slice value() const override {
+            return _iter->value();
+        }
+
+        rocksdb::Status status() const override {
+            return _iter->status();
+        }
+
+    private:
+        std::string _lower;
+        std::string _upper;
+        rocksdb::Slice _lower_bound;
+        rocksdb::Slice _upper_bound;
+        std::shared_ptr<MetaKVSnapshot> _snapshot;
+        std::unique_ptr<rocksdb::Iterator> _iter;
+    };
+
+    class RocksMetaKVSnapshot : public MetaKVSnapshot, public std::enable_shared_from_this<RocksMetaKVSnapshot> {
+    public:
+        explicit RocksMetaKVSnapshot(RocksStorage *rocksdb) : _rocksdb(rocksdb), _snapshot(rocksdb->get_snapshot()) {}
+
+        ~RocksMetaKVSnapshot() override {
+            _rocksdb->release_snapshot(_snapshot);
+        }
+
+        int get(const std::string &key, std::string *value) override {
+            rocksdb::ReadOptions read_options;
+            read_options.snapshot = _snapshot;
+            read_options.fill_cache = false;
+            auto s = _rocksdb->get(read_options, _rocksdb->get_meta_info_handle(), key, value);
+            if (s.IsNotFound()) {
+                return 1;
+            }
+            if (!s.ok()) {
+                TLOG_WARN("get rocksdb fail, err_msg: {}, key: {}", s.ToString(), key);
+                return -1;
+            }
+            return 0;
+        }
+
+        /// a snapshot is scanned once, to be saved or loaded, keep the block cache for the queries
+        rocksdb::Iterator *new_iterator(const std::string &prefix) override {
+            rocksdb::ReadOptions read_options;
+            read_options.snapshot = _snapshot;
+            read_options.fill_cache = false;
+            return new RocksPrefixIterator(_rocksdb, read_options, prefix, shared_from_this());
+        }
+
+    private:
+        RocksStorage *_rocksdb;
+        const rocksdb::Snapshot *_snapshot;
+    };
+
+    int RocksMetaKV::init() {
+        _rocksdb = RocksStorage::get_instance();
+        if (!_rocksdb) {
+            TLOG_ERROR("create rocksdb handler failed");
+            return -1;
+        }
+        int ret = _rocksdb->init(FLAGS_discovery_db_path);
+        if (ret != 0) {
+            TLOG_ERROR("rocksdb init failed: code:{}", ret);
+            return -1;
+        }
+        TLOG_WARN("rocksdb init success, db_path:{}", FLAGS_discovery_db_path);
+        return 0;
+    }
+
+    int RocksMetaKV::write(const std::vector<std::string> &put_keys,
+                           const std::vector<std::string> &put_values,
+                           const std::vector<std::string> &delete_keys) {
+        if (put_keys.size() != put_values.size()) {
+            TLOG_WARN("input keys'size is not equal to values' size");
+            return -1;
+        }
+        rocksdb::WriteOptions write_option;
+        write_option.disableWAL = true;
+        rocksdb::WriteBatch batch;
+        auto handle = _rocksdb->get_meta_info_handle();
+        for (size_t i = 0; i < put_keys.size(); ++i) {
+            batch.Put(handle, put_keys[i], put_values[i]);
+        }
+        for (auto &delete_key: delete_keys) {
+            batch.Delete(handle, delete_key);
+        }
+        auto status = _rocksdb->write(write_option, &batch);
+        if (!status.ok()) {
+            TLOG_WARN("write batch to rocksdb fail,  {}", status.ToString());
+            return -1;
+        }
+        return 0;
+    }
+
+    int RocksMetaKV::get(const std::string &key, std::string *value) {
+        rocksdb::ReadOptions options;
+        auto status = _rocksdb->get(options, _rocksdb->get_meta_info_handle(), rocksdb::Slice(key), value);
+        if (status.IsNotFound()) {
+            return 1;
+        }
+        if (!status.ok()) {
+            TLOG_WARN("get rocksdb fail, err_msg: {}, key: {}", status.ToString(), key);
+            return -1;
+        }
+        return 0;
+    }
+
+    rocksdb::Iterator *RocksMetaKV::new_iterator(const std::string &prefix) {
+        return new RocksPrefixIterator(_rocksdb, rocksdb::ReadOptions(), prefix, nullptr);
+    }
+
+    std::shared_ptr<MetaKVSnapshot> RocksMetaKV::snapshot() {
+        return std::make_shared<RocksMetaKVSnapshot>(_rocksdb);
+    }
+
+    void RocksMetaKV::flush() {
+        rocksdb::FlushOptions flush_options;
+        auto status = _rocksdb->flush(flush_options, _rocksdb->get_meta_info_handle());
+        if (!status.ok()) {
+            TLOG_WARN("flush discovery info to rocksdb fail, err_msg:{}", status.ToString());
+        }
+        status = _rocksdb->flush(flush_options, _rocksdb->get_raft_log_handle());
+        if (!status.ok()) {
+            TLOG_WARN("flush log_cf to rocksdb fail, err_msg:{}", status.ToString());
+        }
+    }
+
+    bool RocksMetaKV::is_stall() {
+        return _rocksdb->is_any_stall();
+    }
+
+    rocksdb::Options RocksMetaKV::options() {
+        return _rocksdb->get_options(_rocksdb->get_meta_info_handle());
+    }
+
+    int RocksMetaKV::ingest(const std::vector<std::string> &files) {
+        auto handle = _rocksdb->create_meta_info_handle();
+        if (handle == nullptr) {
+            return -1;
+        }
+        for (auto &file: files) {
+            /// one file per ingestion, a later delta overrides the keys of the files before it
+            rocksdb::IngestExternalFileOptions ifo;
+            auto res = _rocksdb->ingest_external_file(handle, {file}, ifo);
+            if (!res.ok()) {
+                TLOG_WARN("Error while ingest file {}, Error {}", file, res.ToString());
+                _rocksdb->drop_meta_info_handle(handle);
+                return -1;
+            }
+        }
+        if (_rocksdb->swap_meta_info_handle(handle) != 0) {
+            _rocksdb->drop_meta_info_handle(handle);
+            return -1;
+        }
+        return 0;
+    }
+
+}  // namespace EA::discovery
@@ -0,0 +1,62 @@
+// Copyright 2023 The Elastic AI Search Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "ea/discovery/meta_kv.h"
+#include "ea/storage/rocks_storage.h"
+
+namespace EA::discovery {
+
+    /// the discovery meta info in the meta info column family of RocksStorage, written without
+    /// the rocksdb WAL, the raft log replays what the memtables lose
+    class RocksMetaKV : public MetaKV {
+    public:
+        const char *name() const override {
+            return "rocksdb";
+        }
+
+        int init() override;
+
+        int write(const std::vector<std::string> &put_keys,
+                  const std::vector<std::string> &put_values,
+                  const std::vector<std::string> &delete_keys) override;
+
+        int get(const std::string &key, std::string *value) override;
+
+        rocksdb::Iterator *new_iterator(const std::string &prefix) override;
+
+        std::shared_ptr<MetaKVSnapshot> snapshot() override;
+
+        void flush() override;
+
+        bool is_stall() override;
+
+        /// the options the sst files of a snapshot are written with
+        rocksdb::Options options();
+
+        /// installs the sst files, in order, into an empty meta info column family swapped in at the end,
+        /// the old data is dropped with its column family instead of being covered by range tombstones
+        int ingest(const std::vector<std::string> &files);
+
+    private:
+        RocksStorage *_rocksdb = nullptr;
+    };
+
+}  // namespace EA::discovery
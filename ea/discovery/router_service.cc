@@ -14,7 +14,6 @@
 
 #include "eapi/discovery/discovery.interface.pb.h"
 #include "ea/discovery/router_service.h"
-#include "ea/base/bthread.h"
 
 namespace EA::discovery {
 
@@ -22,6 +21,9 @@ namespace EA::discovery {
         if(_is_init) {
             return  turbo::OkStatus();
         }
+        _channel_cache = std::make_shared<EA::client::ChannelCache>();
+        _manager_sender.set_channel_cache(_channel_cache);
+        _query_sender.set_channel_cache(_channel_cache);
         auto rs = _manager_sender.init(discovery_peers);
         if(!rs.ok()) {
             return rs;
@@ -33,37 +35,36 @@ namespace EA::discovery {
         _is_init = true;
         return turbo::OkStatus();
     }
+
+    /// the sender calls back from the backend response, the brpc worker is not held meanwhile
     void RouterServiceImpl::discovery_manager(::google::protobuf::RpcController* controller,
                       const ::EA::discovery::DiscoveryManagerRequest* request,
                       ::EA::discovery::DiscoveryManagerResponse* response,
                       ::google::protobuf::Closure* done) {
-
-        auto rpc_discovery_func = [controller, request,response, done,this](){
+        auto on_response = [controller, done](const turbo::Status &status) {
             brpc::ClosureGuard done_guard(done);
-            auto ret = _manager_sender.discovery_manager(*request, *response, 2);
-            if(!ret.ok()) {
-                TLOG_ERROR("rpc to discovery server:discovery_manager error:{}", controller->ErrorText());
+            if(!status.ok()) {
+                TLOG_ERROR("rpc to discovery server:discovery_manager error:{}", status.message());
+                static_cast<brpc::Controller *>(controller)->SetFailed(brpc::EINTERNAL, "%s",
+                                                                       std::string(status.message()).c_str());
             }
         };
-        EA::Bthread bth;
-        bth.run(rpc_discovery_func);
-        bth.join();
+        _manager_sender.async_discovery_manager(request, response, on_response, 2);
     }
 
     void RouterServiceImpl::discovery_query(::google::protobuf::RpcController* controller,
                const ::EA::discovery::DiscoveryQueryRequest* request,
                ::EA::discovery::DiscoveryQueryResponse* response,
                ::google::protobuf::Closure* done) {
-        auto rpc_discovery_func = [controller, request,response, done, this](){
+        auto on_response = [controller, done](const turbo::Status &status) {
             brpc::ClosureGuard done_guard(done);
-            auto ret = _query_sender.discovery_query(*request, *response, 2);
-            if(!ret.ok()) {
-                TLOG_ERROR("rpc to discovery server:discovery_manager error:{}", controller->ErrorText());
+            if(!status.ok()) {
+                TLOG_ERROR("rpc to discovery server:discovery_query error:{}", status.message());
+                static_cast<brpc::Controller *>(controller)->SetFailed(brpc::EINTERNAL, "%s",
+                                                                       std::string(status.message()).c_str());
             }
         };
-        EA::Bthread bth;
-        bth.run(rpc_discovery_func);
-        bth.join();
+        _query_sender.async_discovery_query(request, response, on_response, 2);
     }
 
 }  // namespace EA::discovery
@@ -46,9 +46,11 @@ namespace EA::discovery {
                         ::google::protobuf::Closure *done) override;
 
     private:
-        bool _is_init;
+        bool _is_init{false};
         EA::client::DiscoverySender _manager_sender;
         EA::client::DiscoverySender _query_sender;
+        /// shared by _manager_sender and _query_sender
+        std::shared_ptr<EA::client::ChannelCache> _channel_cache;
     };
 
 }  // namespace EA::discovery
@@ -163,20 +163,15 @@ namespace EA::discovery {
         return 0;
     }
 
-    int SchemaManager::load_snapshot() {
+    int SchemaManager::load_snapshot(rocksdb::Iterator *iter) {
         TLOG_INFO("SchemaManager start load_snapshot");
         NamespaceManager::get_instance()->clear();
         ZoneManager::get_instance()->clear();
         ServletManager::get_instance()->clear();
         InstanceManager::get_instance()->clear();
-        //创建一个snapshot
-        rocksdb::ReadOptions read_options;
-        read_options.prefix_same_as_start = true;
-        read_options.total_order_seek = false;
-        RocksStorage *db = RocksStorage::get_instance();
-        std::unique_ptr<rocksdb::Iterator> iter(
-                RocksStorage::get_instance()->new_iterator(read_options, db->get_meta_info_handle()));
-        iter->Seek(DiscoveryConstants::SCHEMA_IDENTIFY);
+        if (iter->Valid() && iter->key().compare(DiscoveryConstants::SCHEMA_IDENTIFY) < 0) {
+            iter->Seek(DiscoveryConstants::SCHEMA_IDENTIFY);
+        }
         std::string max_id_prefix = DiscoveryConstants::SCHEMA_IDENTIFY;
         max_id_prefix += DiscoveryConstants::MAX_ID_SCHEMA_IDENTIFY;
 
@@ -191,7 +186,7 @@ namespace EA::discovery {
         servlet_prefix += DiscoveryConstants::SERVLET_SCHEMA_IDENTIFY;
 
 
-        for (; iter->Valid(); iter->Next()) {
+        for (; iter->Valid() && iter->key().starts_with(DiscoveryConstants::SCHEMA_IDENTIFY); iter->Next()) {
             int ret = 0;
             if (iter->key().starts_with(zone_prefix)) {
                 ret = ZoneManager::get_instance()->load_zone_snapshot(iter->value().ToString());
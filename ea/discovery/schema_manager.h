@@ -50,7 +50,11 @@ namespace EA::discovery {
         /// \return
         int check_and_get_for_instance(EA::discovery::ServletInstance &instance);
 
-        int load_snapshot();
+        ///
+        /// \param iter shared by the managers loading a snapshot in one pass, it is left at the first
+        ///        key after the schema keys
+        /// \return
+        int load_snapshot(rocksdb::Iterator *iter);
 
         ///
         /// \param discovery_state_machine
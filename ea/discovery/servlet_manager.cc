@@ -118,7 +118,7 @@ namespace EA::discovery {
         // TODO check no instance of servlet
         // persist to rocksdb
         int ret = DiscoveryRocksdb::get_instance()->remove_discovery_info(
-                std::vector<std::string>{construct_servlet_key(zone_id)});
+                std::vector<std::string>{construct_servlet_key(servlet_id)});
         if (ret < 0) {
             TLOG_WARN("drop zone: {} to rocksdb fail", zone_name);
             IF_DONE_SET_RESPONSE(done, EA::discovery::INTERNAL_ERROR, "write db fail");
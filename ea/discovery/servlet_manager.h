@@ -20,6 +20,7 @@
 #include <set>
 #include <mutex>
 #include "ea/discovery/discovery_constants.h"
+#include "ea/discovery/key_encoder.h"
 #include "eapi/discovery/discovery.interface.pb.h"
 #include "bthread/mutex.h"
 #include "braft/raft.h"
@@ -113,6 +114,11 @@ namespace EA::discovery {
         /// \return
         static std::string make_servlet_key(const std::string &zone_key,const std::string &servlet_name);
 
+        ///
+        /// \param servlet_id
+        /// \return order preserving, big endian with the sign bit flipped
+        static std::string construct_servlet_key(int64_t servlet_id);
+
     private:
         ServletManager();
 
@@ -124,11 +130,6 @@ namespace EA::discovery {
         /// \param servlet_info
         void set_servlet_info(const EA::discovery::ServletInfo &servlet_info);
 
-        ///
-        /// \param servlet_id
-        /// \return
-        std::string construct_servlet_key(int64_t servlet_id);
-
         ///
         /// \return
         std::string construct_max_servlet_id_key();
@@ -198,7 +199,7 @@ namespace EA::discovery {
     inline std::string ServletManager::construct_servlet_key(int64_t servlet_id) {
         std::string servlet_key = DiscoveryConstants::SCHEMA_IDENTIFY
                                    + DiscoveryConstants::SERVLET_SCHEMA_IDENTIFY;
-        servlet_key.append((char *) &servlet_id, sizeof(int64_t));
+        KeyEncoder::append_i64(servlet_key, servlet_id);
         return servlet_key;
     }
 
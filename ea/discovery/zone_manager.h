@@ -20,6 +20,7 @@
 #include <set>
 #include <mutex>
 #include "ea/discovery/discovery_constants.h"
+#include "ea/discovery/key_encoder.h"
 #include "eapi/discovery/discovery.interface.pb.h"
 #include "bthread/mutex.h"
 #include "braft/raft.h"
@@ -130,6 +131,8 @@ namespace EA::discovery {
         /// \return
         static std::string make_zone_key(const std::string &namespace_name, const std::string &zone_name);
 
+        static std::string construct_zone_key(int64_t zone_id);
+
     private:
         ZoneManager();
 
@@ -137,8 +140,6 @@ namespace EA::discovery {
 
         void set_zone_info(const EA::discovery::ZoneInfo &zone_info);
 
-        std::string construct_zone_key(int64_t zone_id);
-
         std::string construct_max_zone_id_key();
 
     private:
@@ -231,7 +232,7 @@ namespace EA::discovery {
     inline std::string ZoneManager::construct_zone_key(int64_t zone_id) {
         std::string zone_key = DiscoveryConstants::SCHEMA_IDENTIFY
                                + DiscoveryConstants::ZONE_SCHEMA_IDENTIFY;
-        zone_key.append((char *) &zone_id, sizeof(int64_t));
+        KeyEncoder::append_i64(zone_key, zone_id);
         return zone_key;
     }
 
@@ -18,6 +18,29 @@
 
 namespace EA {
     DEFINE_string(config_cache_dir, "./config_cache", "config cache dir");
+    DEFINE_int32(config_cache_sync_interval_ms, 1000,
+                 "the config cache file is fsynced at most once in the interval, 0 to fsync every write");
+    DEFINE_int64(metadata_cache_ttl_ms, 5000, "metadata cache responses younger than it are served without rpc");
+    DEFINE_int64(metadata_cache_max_stale_ms, 60000,
+                 "metadata cache responses younger than it are served while refreshed in background");
     DEFINE_int32(config_watch_interval_ms, 1, "config watch sleep between two watch config");
     DEFINE_int32(config_watch_interval_round_s, 30, "every x(s) to fetch and get config for a round");
+    DEFINE_bool(config_watch_push, true, "wait for config changes pushed by the server, polling is used when it fails");
+    DEFINE_int32(config_watch_concurrency, 8, "max configs fetched at the same time by the config watch");
+    DEFINE_int32(discovery_watch_rpc_timeout_ms, 15000,
+                 "rpc timeout of the watch queries held by the server, should be longer than "
+                 "discovery_instance_watch_timeout_ms and discovery_config_watch_timeout_ms of the server");
+    DEFINE_string(discovery_connection_type, "pooled",
+                  "connection type of the channels to discovery/router server: single, pooled or short");
+    DEFINE_int32(discovery_retry_backoff_base_ms, 20,
+                 "first backoff before retrying a discovery request, doubled on each retry up to the interval time");
+    DEFINE_string(discovery_read_lb, "",
+                  "load balancer of the discovery queries over all the nodes: la, rr, c_murmurhash..., "
+                  "empty to send them to the leader. replies from followers may lag the leader, a write is "
+                  "not always seen by the next read then");
+    DEFINE_bool(discovery_hedge_read, false,
+                "send a backup query to another discovery node when there is no reply after the p95 latency");
+    DEFINE_int32(discovery_hedge_read_min_ms, 10, "min delay before sending the backup request of a hedged query");
+    DEFINE_int32(discovery_leader_probe_timeout_ms, 200,
+                 "timeout of asking the discovery nodes for the leader, the nodes are asked at the same time");
 }  // namespace EA
\ No newline at end of file
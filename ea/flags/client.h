@@ -21,8 +21,20 @@
 
 namespace EA {
     DECLARE_string(config_cache_dir);
+    DECLARE_int32(config_cache_sync_interval_ms);
+    DECLARE_int64(metadata_cache_ttl_ms);
+    DECLARE_int64(metadata_cache_max_stale_ms);
     DECLARE_int32(config_watch_interval_ms);
     DECLARE_int32(config_watch_interval_round_s);
+    DECLARE_bool(config_watch_push);
+    DECLARE_int32(config_watch_concurrency);
+    DECLARE_int32(discovery_watch_rpc_timeout_ms);
+    DECLARE_string(discovery_connection_type);
+    DECLARE_int32(discovery_retry_backoff_base_ms);
+    DECLARE_string(discovery_read_lb);
+    DECLARE_bool(discovery_hedge_read);
+    DECLARE_int32(discovery_hedge_read_min_ms);
+    DECLARE_int32(discovery_leader_probe_timeout_ms);
 }
 
 #endif  // EA_FLAGS_CLIENT_H_
@@ -21,6 +21,8 @@ namespace EA {
     DEFINE_string(discovery_server_peers, "127.0.0.1:8010", "discovery server peers");
     DEFINE_int32(discovery_replica_number, 3, "Meta replica num");
     DEFINE_int32(discovery_snapshot_interval_s, 600, "raft snapshot interval(s)");
+    DEFINE_int32(discovery_snapshot_max_deltas, 16,
+                 "max delta sst files chained to a base sst in a discovery snapshot, 0 to always save a full snapshot");
     DEFINE_int32(discovery_election_timeout_ms, 1000, "raft election timeout(ms)");
     DEFINE_string(discovery_raft_group, "discovery_raft", "discovery raft group");
     DEFINE_string(discovery_log_uri, "local://./discovery/raft_log/", "raft log uri");
@@ -29,6 +31,9 @@ namespace EA {
     DEFINE_int64(discovery_check_migrate_interval_us, 60 * 1000 * 1000LL, "check discovery server migrate interval (60s)");
     DEFINE_int32(discovery_tso_snapshot_interval_s, 60, "tso raft snapshot interval(s)");
     DEFINE_string(discovery_db_path, "./discovery/rocks_db", "rocks db path");
+    DEFINE_string(discovery_meta_store, "rocksdb",
+                  "backend of the discovery meta info, rocksdb or memory. memory keeps it in a map recovered "
+                  "from the raft snapshot and log, for small clusters, the same in a raft group");
     DEFINE_string(discovery_listen,"127.0.0.1:8010", "discovery listen addr");
     DEFINE_int32(discovery_request_timeout, 30000,
                  "discovery as server request timeout, default:30000ms");
@@ -37,6 +42,17 @@ namespace EA {
 
     DEFINE_string(backup_discovery_server_peers, "", "backup_discovery_server_peers");
     DEFINE_int64(time_between_discovery_connect_error_ms, 0, "time_between_discovery_connect_error_ms. default(0ms)");
+    DEFINE_int32(discovery_instance_watch_timeout_ms, 10000,
+                 "max time a instance watch request is held when nothing changed, default:10000ms");
+    DEFINE_int32(discovery_config_watch_timeout_ms, 10000,
+                 "max time a config watch request is held when nothing changed, default:10000ms");
+    DEFINE_int32(discovery_config_compress_threshold, 4096,
+                 "config content larger than this(bytes) is stored and transferred snappy compressed, 0 to disable");
+    DEFINE_int32(discovery_admission_adjust_interval_ms, 1000,
+                 "interval the discovery_manager admission rate is adjusted to the stalls, default:1000ms");
+    DEFINE_int64(discovery_admission_max_apply_lag, 1000,
+                 "raft entries committed but not applied above which the admission rate is halved");
+    DEFINE_int64(discovery_admission_min_rate, 100, "min discovery_manager admission rate(requests per second)");
 
 
 }  // namespace EA
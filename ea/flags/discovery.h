@@ -25,6 +25,8 @@ namespace EA {
     DECLARE_string(discovery_server_peers);
     DECLARE_int32(discovery_replica_number);
     DECLARE_int32(discovery_snapshot_interval_s);
+    DECLARE_int32(discovery_snapshot_max_deltas);
+    DECLARE_string(discovery_meta_store);
     DECLARE_int32(discovery_election_timeout_ms);
     DECLARE_string(discovery_raft_group);
     DECLARE_string(discovery_log_uri);
@@ -38,6 +40,12 @@ namespace EA {
     DECLARE_int32(discovery_connect_timeout);
     DECLARE_string(backup_discovery_server_peers);
     DECLARE_int64(time_between_discovery_connect_error_ms);
+    DECLARE_int32(discovery_instance_watch_timeout_ms);
+    DECLARE_int32(discovery_config_watch_timeout_ms);
+    DECLARE_int32(discovery_config_compress_threshold);
+    DECLARE_int32(discovery_admission_adjust_interval_ms);
+    DECLARE_int64(discovery_admission_max_apply_lag);
+    DECLARE_int64(discovery_admission_min_rate);
 
 }  // namespace EA
 
@@ -28,6 +28,14 @@ namespace EA {
     DEFINE_bool(rocks_skip_stats_update_on_db_open, false, "rocks_skip_stats_update_on_db_open");
     DEFINE_int32(rocks_block_size, 64 * 1024, "rocksdb block_cache size, default: 64KB");
     DEFINE_int64(rocks_block_cache_size_mb, 8 * 1024, "rocksdb block_cache_size_mb, default: 8G");
+    DEFINE_int64(rocks_meta_block_cache_size_mb, 0,
+                 "block cache of the meta info column family, kept apart from the data scans, "
+                 "0 to share the block cache, default: 0");
+    DEFINE_int64(rocks_memory_budget_mb, 0,
+                 "memory budget of rocksdb, the block caches and the memtables, replaces "
+                 "rocks_block_cache_size_mb when set, 0 to disable, default: 0");
+    DEFINE_double(rocks_memtable_budget_ratio, 0.25,
+                  "part of rocks_memory_budget_mb for the memtables, charged to the block cache, default: 0.25");
     DEFINE_uint64(rocks_hard_pending_compaction_g, 256, "rocksdb hard_pending_compaction_bytes_limit , default: 256G");
     DEFINE_uint64(rocks_soft_pending_compaction_g, 64, "rocksdb soft_pending_compaction_bytes_limit , default: 64G");
     DEFINE_uint64(rocks_compaction_readahead_size, 0, "rocksdb compaction_readahead_size, default: 0");
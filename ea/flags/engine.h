@@ -30,6 +30,9 @@ namespace EA {
     DECLARE_bool(rocks_skip_stats_update_on_db_open);
     DECLARE_int32(rocks_block_size);
     DECLARE_int64(rocks_block_cache_size_mb);
+    DECLARE_int64(rocks_meta_block_cache_size_mb);
+    DECLARE_int64(rocks_memory_budget_mb);
+    DECLARE_double(rocks_memtable_budget_ratio);
     DECLARE_uint64(rocks_hard_pending_compaction_g);
     DECLARE_uint64(rocks_soft_pending_compaction_g);
     DECLARE_uint64(rocks_compaction_readahead_size);
@@ -19,17 +19,84 @@
 #include "rocksdb/filter_policy.h"
 #include "rocksdb/statistics.h"
 #include <iostream>
+#include <mutex>
+#include <set>
 #include "ea/storage/simple_listener.h"
 #include "ea/storage/transaction_db_bthread_mutex.h"
 #include "turbo/strings/numbers.h"
 #include "ea/base/bthread.h"
+#include "butil/time.h"
+#include "gflags/gflags.h"
 
 
 namespace EA {
 
+    /// the gflags of the rocksdb options apply to the running db when set by /flags?setvalue=,
+    /// a value rocksdb refuses leaves the flag unchanged
+    static bool validate_rocks_int32_option(const char *flag_name, int32_t value) {
+        return RocksStorage::get_instance()->adjust_option({{flag_name, std::to_string(value)}}) == 0;
+    }
+
+    static bool validate_rocks_uint64_option(const char *flag_name, uint64_t value) {
+        return RocksStorage::get_instance()->adjust_option({{flag_name, std::to_string(value)}}) == 0;
+    }
+
+    static bool validate_rocks_double_option(const char *flag_name, double value) {
+        return RocksStorage::get_instance()->adjust_option({{flag_name, std::to_string(value)}}) == 0;
+    }
+
+    static void register_rocks_option_validators() {
+        google::RegisterFlagValidator(&FLAGS_level0_file_num_compaction_trigger, validate_rocks_int32_option);
+        google::RegisterFlagValidator(&FLAGS_slowdown_write_sst_cnt, validate_rocks_int32_option);
+        google::RegisterFlagValidator(&FLAGS_stop_write_sst_cnt, validate_rocks_int32_option);
+        google::RegisterFlagValidator(&FLAGS_rocks_hard_pending_compaction_g, validate_rocks_uint64_option);
+        google::RegisterFlagValidator(&FLAGS_rocks_soft_pending_compaction_g, validate_rocks_uint64_option);
+        google::RegisterFlagValidator(&FLAGS_target_file_size_base, validate_rocks_int32_option);
+        google::RegisterFlagValidator(&FLAGS_rocks_level_multiplier, validate_rocks_double_option);
+        google::RegisterFlagValidator(&FLAGS_max_write_buffer_number, validate_rocks_int32_option);
+        google::RegisterFlagValidator(&FLAGS_write_buffer_size, validate_rocks_int32_option);
+        google::RegisterFlagValidator(&FLAGS_max_bytes_for_level_base, validate_rocks_int32_option);
+        google::RegisterFlagValidator(&FLAGS_rocks_max_background_compactions, validate_rocks_int32_option);
+        google::RegisterFlagValidator(&FLAGS_rocks_max_subcompactions, validate_rocks_int32_option);
+        google::RegisterFlagValidator(&FLAGS_max_background_jobs, validate_rocks_int32_option);
+    }
+
+    /// the meta info keys are <family(1)><sub type(1)>... for the schema(0x01) and the discovery(0x03)
+    /// families, and <family(1)><name> for the others, so a prefix is the first two bytes of the
+    /// families with a sub type, and the first byte otherwise
+    class MetaInfoPrefixTransform : public rocksdb::SliceTransform {
+    public:
+        const char *Name() const override {
+            return "ea.MetaInfoPrefix";
+        }
+
+        rocksdb::Slice Transform(const rocksdb::Slice &key) const override {
+            return rocksdb::Slice(key.data(), prefix_size(key));
+        }
+
+        bool InDomain(const rocksdb::Slice &key) const override {
+            return !key.empty() && key.size() >= prefix_size(key);
+        }
+
+    private:
+        static size_t prefix_size(const rocksdb::Slice &key) {
+            if (key.empty()) {
+                return 1;
+            }
+            auto family = static_cast<uint8_t>(key[0]);
+            return family == 0x01 || family == 0x03 ? 2 : 1;
+        }
+    };
+
+    /// meta_info, or meta_info_<us> installed from a snapshot
+    static bool is_meta_info_cf(const std::string &name) {
+        return name == RocksStorage::META_INFO_CF || name.rfind(RocksStorage::META_INFO_CF + "_", 0) == 0;
+    }
+
     const std::string RocksStorage::RAFT_LOG_CF = "raft_log";
     const std::string RocksStorage::DATA_CF = "data";
     const std::string RocksStorage::META_INFO_CF = "meta_info";
+    const std::string RocksStorage::ACTIVE_META_INFO_CF_KEY = "active_meta_info_cf";
     std::atomic<int64_t> RocksStorage::raft_cf_remove_range_count = {0};
     std::atomic<int64_t> RocksStorage::data_cf_remove_range_count = {0};
     std::atomic<int64_t> RocksStorage::mata_cf_remove_range_count = {0};
@@ -56,6 +123,19 @@ namespace EA {
             }
         }
         std::shared_ptr<rocksdb::EventListener> my_listener = std::make_shared<SimpleListener>();
+        /// with a budget the meta cache is carved out of it, and the memtables are charged
+        /// to the shared cache, so the caches and the memtables never outgrow the budget together
+        int64_t block_cache_size = FLAGS_rocks_block_cache_size_mb * 1024 * 1024LL;
+        int64_t meta_cache_size = FLAGS_rocks_meta_block_cache_size_mb * 1024 * 1024LL;
+        if (FLAGS_rocks_memory_budget_mb > 0) {
+            int64_t budget = FLAGS_rocks_memory_budget_mb * 1024 * 1024LL;
+            if (meta_cache_size >= budget) {
+                TLOG_ERROR("rocks_meta_block_cache_size_mb:{} is not less than rocks_memory_budget_mb:{}",
+                           FLAGS_rocks_meta_block_cache_size_mb, FLAGS_rocks_memory_budget_mb);
+                return -1;
+            }
+            block_cache_size = budget - meta_cache_size;
+        }
         rocksdb::BlockBasedTableOptions table_options;
         if (FLAGS_rocks_use_partitioned_index_filters) {
             // use Partitioned Index Filters
@@ -67,20 +147,23 @@ namespace EA {
             table_options.pin_top_level_index_and_filter = true;
             table_options.cache_index_and_filter_blocks_with_high_priority = true;
             table_options.pin_l0_filter_and_index_blocks_in_cache = true;
-            table_options.block_cache = rocksdb::NewLRUCache(FLAGS_rocks_block_cache_size_mb * 1024 * 1024LL,
-                                                             8, false, FLAGS_rocks_high_pri_pool_ratio);
+            table_options.block_cache = rocksdb::NewLRUCache(block_cache_size, 8, false,
+                                                             FLAGS_rocks_high_pri_pool_ratio);
             // 通过cache控制内存，不需要控制max_open_files
             FLAGS_rocks_max_open_files = -1;
         } else {
             table_options.data_block_index_type = rocksdb::BlockBasedTableOptions::kDataBlockBinaryAndHash;
             if (FLAGS_rocks_use_hyper_clock_cache) {
 #if ROCKSDB_MAJOR == 7
-                auto cache_opt = rocksdb::HyperClockCacheOptions(FLAGS_rocks_block_cache_size_mb * 1024 * 1024LL, FLAGS_rocks_block_size, 8);
+                auto cache_opt = rocksdb::HyperClockCacheOptions(block_cache_size, FLAGS_rocks_block_size, 8);
                 cache_opt.metadata_charge_policy = rocksdb::kDontChargeCacheMetadata; //cache会比rocks_block_cache_size_mb多占用少量内存
                 table_options.block_cache = cache_opt.MakeSharedCache();
+#else
+                TLOG_WARN("hyper clock cache needs rocksdb 7, use lru cache");
+                table_options.block_cache = rocksdb::NewLRUCache(block_cache_size, 8);
 #endif
             } else {
-                table_options.block_cache = rocksdb::NewLRUCache(FLAGS_rocks_block_cache_size_mb * 1024 * 1024LL, 8);
+                table_options.block_cache = rocksdb::NewLRUCache(block_cache_size, 8);
             }
         }
         table_options.format_version = 4;
@@ -92,6 +175,12 @@ namespace EA {
             table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10));
         }
         _cache = table_options.block_cache.get();
+        rocksdb::BlockBasedTableOptions meta_table_options = table_options;
+        if (meta_cache_size > 0) {
+            meta_table_options.block_cache = rocksdb::NewLRUCache(meta_cache_size, 4, false,
+                                                                  FLAGS_rocks_high_pri_pool_ratio);
+        }
+        _meta_cache = meta_table_options.block_cache.get();
         rocksdb::Options db_options;
         db_options.IncreaseParallelism(FLAGS_max_background_jobs);
         db_options.create_if_missing = true;
@@ -113,6 +202,14 @@ namespace EA {
         db_options.max_background_flushes = 2;
         db_options.env->SetBackgroundThreads(2, rocksdb::Env::HIGH);
         db_options.listeners.emplace_back(my_listener);
+        if (FLAGS_rocks_memory_budget_mb > 0) {
+            size_t memtable_size = FLAGS_rocks_memory_budget_mb * 1024 * 1024LL * FLAGS_rocks_memtable_budget_ratio;
+            _write_buffer_manager = std::make_shared<rocksdb::WriteBufferManager>(memtable_size,
+                                                                                  table_options.block_cache);
+            db_options.write_buffer_manager = _write_buffer_manager;
+            TLOG_INFO("rocksdb memory budget:{}MB, block cache:{}, meta block cache:{}, memtables:{}",
+                      FLAGS_rocks_memory_budget_mb, block_cache_size, meta_cache_size, memtable_size);
+        }
         rocksdb::TransactionDBOptions txn_db_options;
         TLOG_INFO("FLAGS_rocks_transaction_lock_timeout_ms:{} FLAGS_rocks_default_lock_timeout_ms:{}",
                   FLAGS_rocks_transaction_lock_timeout_ms, FLAGS_rocks_default_lock_timeout_ms);
@@ -187,8 +284,12 @@ namespace EA {
             _data_cf_option.bottommost_compression_opts.zstd_max_train_bytes = 1 << 18; // 256KB
         }
 
-        _meta_info_option.prefix_extractor.reset(
-                rocksdb::NewFixedPrefixTransform(1));
+        /// a seek for a whole family, one byte, is out of the domain and falls back to total order
+        _meta_info_option.prefix_extractor.reset(new MetaInfoPrefixTransform());
+        _meta_info_option.memtable_prefix_bloom_size_ratio = 0.1;
+        _meta_info_option.memtable_whole_key_filtering = true;
+        /// the full filter holds both the prefixes and the whole keys for the point gets
+        _meta_info_option.table_factory.reset(rocksdb::NewBlockBasedTableFactory(meta_table_options));
         _meta_info_option.OptimizeLevelStyleCompaction();
         _meta_info_option.compaction_pri = rocksdb::kOldestSmallestSeqFirst;
         _meta_info_option.level_compaction_dynamic_level_bytes = FLAGS_rocks_data_dynamic_level_bytes;
@@ -209,8 +310,9 @@ namespace EA {
                     column_family_desc.push_back(rocksdb::ColumnFamilyDescriptor(RAFT_LOG_CF, _log_cf_option));
                 } else if (column_family_name == DATA_CF) {
                     column_family_desc.push_back(rocksdb::ColumnFamilyDescriptor(DATA_CF, _data_cf_option));
-                } else if (column_family_name == META_INFO_CF) {
-                    column_family_desc.push_back(rocksdb::ColumnFamilyDescriptor(META_INFO_CF, _meta_info_option));
+                } else if (is_meta_info_cf(column_family_name)) {
+                    column_family_desc.push_back(rocksdb::ColumnFamilyDescriptor(column_family_name,
+                                                                                 _meta_info_option));
                 } else {
                     column_family_desc.push_back(
                             rocksdb::ColumnFamilyDescriptor(column_family_name,
@@ -270,12 +372,33 @@ namespace EA {
                 return -1;
             }
         }
-        if (0 == _column_families.count(META_INFO_CF)) {
+        std::string meta_info_cf = META_INFO_CF;
+        std::string active_cf;
+        s = _txn_db->Get(rocksdb::ReadOptions(), _txn_db->DefaultColumnFamily(), ACTIVE_META_INFO_CF_KEY, &active_cf);
+        if (s.ok() && _column_families.count(active_cf) == 1) {
+            meta_info_cf = active_cf;
+        }
+        for (auto it = _column_families.begin(); it != _column_families.end();) {
+            if (!is_meta_info_cf(it->first)) {
+                ++it;
+                continue;
+            }
+            if (it->first == meta_info_cf) {
+                _meta_info_handle = it->second;
+            } else {
+                /// left by an interrupted snapshot install, or replaced by one
+                TLOG_WARN("drop stale meta info column family:{}", it->first);
+                _txn_db->DropColumnFamily(it->second);
+                _txn_db->DestroyColumnFamilyHandle(it->second);
+            }
+            it = _column_families.erase(it);
+        }
+        if (_meta_info_handle.load() == nullptr) {
             rocksdb::ColumnFamilyHandle *metainfo_handle;
             s = _txn_db->CreateColumnFamily(_meta_info_option, META_INFO_CF, &metainfo_handle);
             if (s.ok()) {
                 TLOG_INFO("create column family success, column family: {}", META_INFO_CF);
-                _column_families[META_INFO_CF] = metainfo_handle;
+                _meta_info_handle = metainfo_handle;
             } else {
                 TLOG_ERROR("create column family fail, column family:{}, err_message:{}",
                            META_INFO_CF, s.ToString());
@@ -284,6 +407,7 @@ namespace EA {
         }
         _is_init = true;
         collect_rocks_options();
+        expose_memory_metrics();
         TLOG_INFO("rocksdb init success");
         return 0;
     }
@@ -303,6 +427,144 @@ namespace EA {
         _rocks_options["rocks_max_background_compactions"] = "max_background_compactions";
         _rocks_options["rocks_max_subcompactions"] = "max_subcompactions";
         _rocks_options["max_background_jobs"] = "max_background_jobs";
+        static std::once_flag once;
+        std::call_once(once, register_rocks_option_validators);
+    }
+
+    void RocksStorage::expose_memory_metrics() {
+        if (!_memory_metrics.empty()) {
+            return;
+        }
+        add_memory_metric("rocks_block_cache_usage", [this]() {
+            if (_cache == nullptr) {
+                return static_cast<int64_t>(0);
+            }
+            return static_cast<int64_t>(_cache->GetUsage());
+        });
+        add_memory_metric("rocks_block_cache_pinned_usage", [this]() {
+            if (_cache == nullptr) {
+                return static_cast<int64_t>(0);
+            }
+            return static_cast<int64_t>(_cache->GetPinnedUsage());
+        });
+        add_memory_metric("rocks_meta_block_cache_usage", [this]() {
+            if (_meta_cache == nullptr) {
+                return static_cast<int64_t>(0);
+            }
+            return static_cast<int64_t>(_meta_cache->GetUsage());
+        });
+        add_memory_metric("rocks_memtable_usage", [this]() {
+            if (_write_buffer_manager != nullptr) {
+                return static_cast<int64_t>(_write_buffer_manager->memory_usage());
+            }
+            uint64_t value = 0;
+            _txn_db->GetAggregatedIntProperty("rocksdb.cur-size-all-mem-tables", &value);
+            return static_cast<int64_t>(value);
+        });
+        static const std::vector<std::pair<std::string, std::string>> cf_properties = {
+                {"memtable_bytes",      "rocksdb.cur-size-all-mem-tables"},
+                {"live_data_bytes",     "rocksdb.estimate-live-data-size"},
+                {"block_cache_usage",   "rocksdb.block-cache-usage"},
+                {"table_readers_bytes", "rocksdb.estimate-table-readers-mem"}};
+        typedef rocksdb::ColumnFamilyHandle *(RocksStorage::*HandleGetter)();
+        const std::vector<std::pair<std::string, HandleGetter>> cf_handles = {
+                {RAFT_LOG_CF,  &RocksStorage::get_raft_log_handle},
+                {DATA_CF,      &RocksStorage::get_data_handle},
+                {META_INFO_CF, &RocksStorage::get_meta_info_handle}};
+        for (auto &cf: cf_handles) {
+            for (auto &property: cf_properties) {
+                auto get_handle = cf.second;
+                auto property_name = property.second;
+                add_memory_metric(turbo::Format("rocks_{}_{}", cf.first, property.first),
+                                  [this, get_handle, property_name]() {
+                                      /// the meta info handle is reloaded, a snapshot install swaps it
+                                      auto handle = (this->*get_handle)();
+                                      uint64_t value = 0;
+                                      if (handle == nullptr ||
+                                          !_txn_db->GetIntProperty(handle, property_name, &value)) {
+                                          return static_cast<int64_t>(0);
+                                      }
+                                      return static_cast<int64_t>(value);
+                                  });
+            }
+        }
+    }
+
+    void RocksStorage::add_memory_metric(const std::string &name, std::function<int64_t()> getter) {
+        auto metric = std::make_unique<MemoryMetric>();
+        metric->getter = std::move(getter);
+        metric->status = std::make_unique<bvar::PassiveStatus<int64_t>>(name, get_memory_metric, metric.get());
+        _memory_metrics.push_back(std::move(metric));
+    }
+
+    int64_t RocksStorage::get_memory_metric(void *arg) {
+        return static_cast<MemoryMetric *>(arg)->getter();
+    }
+
+    int32_t RocksStorage::adjust_option(const std::map<std::string, std::string> &new_options) {
+        if (!_is_init) {
+            /// the flags are used by init as they are
+            return 0;
+        }
+        static const std::set<std::string> db_option_names = {"max_background_compactions",
+                                                              "max_subcompactions",
+                                                              "max_background_jobs"};
+        std::lock_guard<bthread::Mutex> lock(_options_mutex);
+        std::unordered_map<std::string, std::string> cf_options;
+        std::unordered_map<std::string, std::string> db_options;
+        for (auto &it : new_options) {
+            auto option_it = _rocks_options.find(it.first);
+            if (option_it == _rocks_options.end()) {
+                TLOG_WARN("{} is not a dynamic rocksdb option", it.first);
+                return -1;
+            }
+            auto defined_it = _defined_options.find(it.first);
+            if (defined_it != _defined_options.end() && defined_it->second == it.second) {
+                continue;
+            }
+            std::string value = it.second;
+            if (it.first == "rocks_hard_pending_compaction_g" || it.first == "rocks_soft_pending_compaction_g") {
+                uint64_t size_g = 0;
+                if (!turbo::SimpleAtoi(value, &size_g)) {
+                    TLOG_WARN("bad value {} of {}", value, it.first);
+                    return -1;
+                }
+                value = std::to_string(size_g * 1073741824ull);
+            }
+            if (db_option_names.count(option_it->second) == 1) {
+                db_options[option_it->second] = value;
+            } else {
+                cf_options[option_it->second] = value;
+            }
+        }
+        if (!cf_options.empty()) {
+            for (auto handle: {get_data_handle(), get_meta_info_handle()}) {
+                if (handle == nullptr) {
+                    continue;
+                }
+                auto s = _txn_db->SetOptions(handle, cf_options);
+                if (!s.ok()) {
+                    TLOG_ERROR("set options of column family {} fail, err_message:{}", handle->GetName(),
+                               s.ToString());
+                    return -1;
+                }
+            }
+            /// is_any_stall reads the data options, the snapshot install creates the meta info cf from its options
+            _data_cf_option = rocksdb::ColumnFamilyOptions(_txn_db->GetOptions(get_data_handle()));
+            _meta_info_option = rocksdb::ColumnFamilyOptions(_txn_db->GetOptions(get_meta_info_handle()));
+        }
+        if (!db_options.empty()) {
+            auto s = _txn_db->SetDBOptions(db_options);
+            if (!s.ok()) {
+                TLOG_ERROR("set db options fail, err_message:{}", s.ToString());
+                return -1;
+            }
+        }
+        for (auto &it : new_options) {
+            _defined_options[it.first] = it.second;
+            TLOG_INFO("adjust rocksdb option {}({}) to {}", _rocks_options[it.first], it.first, it.second);
+        }
+        return 0;
     }
 
     rocksdb::Status RocksStorage::remove_range(const rocksdb::WriteOptions &options,
@@ -408,11 +670,62 @@ namespace EA {
             TLOG_ERROR("rocksdb has not been inited");
             return nullptr;
         }
-        if (0 == _column_families.count(META_INFO_CF)) {
+        auto handle = _meta_info_handle.load();
+        if (handle == nullptr) {
             TLOG_ERROR("rocksdb has no meta info column family");
+        }
+        return handle;
+    }
+
+    rocksdb::ColumnFamilyHandle *RocksStorage::create_meta_info_handle() {
+        std::string cf_name = turbo::Format("{}_{}", META_INFO_CF, butil::gettimeofday_us());
+        rocksdb::ColumnFamilyOptions cf_option;
+        {
+            std::lock_guard<bthread::Mutex> lock(_options_mutex);
+            cf_option = _meta_info_option;
+        }
+        rocksdb::ColumnFamilyHandle *handle = nullptr;
+        auto s = _txn_db->CreateColumnFamily(cf_option, cf_name, &handle);
+        if (!s.ok()) {
+            TLOG_ERROR("create column family {} fail, err_message:{}", cf_name, s.ToString());
             return nullptr;
         }
-        return _column_families[META_INFO_CF];
+        TLOG_INFO("create column family success, column family: {}", cf_name);
+        return handle;
+    }
+
+    int32_t RocksStorage::swap_meta_info_handle(rocksdb::ColumnFamilyHandle *handle) {
+        rocksdb::WriteOptions options;
+        options.sync = true;
+        auto s = _txn_db->Put(options, _txn_db->DefaultColumnFamily(), ACTIVE_META_INFO_CF_KEY, handle->GetName());
+        if (!s.ok()) {
+            TLOG_ERROR("persist active meta info column family {} fail, err_message:{}",
+                       handle->GetName(), s.ToString());
+            return -1;
+        }
+        auto old_handle = _meta_info_handle.exchange(handle);
+        TLOG_INFO("swap meta info column family from {} to {}",
+                  old_handle ? old_handle->GetName() : "", handle->GetName());
+        if (old_handle == nullptr) {
+            return 0;
+        }
+        s = _txn_db->DropColumnFamily(old_handle);
+        if (!s.ok()) {
+            TLOG_WARN("drop column family {} fail, err_message:{}", old_handle->GetName(), s.ToString());
+        }
+        if (_retired_meta_info_handle != nullptr) {
+            _txn_db->DestroyColumnFamilyHandle(_retired_meta_info_handle);
+        }
+        _retired_meta_info_handle = old_handle;
+        return 0;
+    }
+
+    void RocksStorage::drop_meta_info_handle(rocksdb::ColumnFamilyHandle *handle) {
+        auto s = _txn_db->DropColumnFamily(handle);
+        if (!s.ok()) {
+            TLOG_WARN("drop column family {} fail, err_message:{}", handle->GetName(), s.ToString());
+        }
+        _txn_db->DestroyColumnFamilyHandle(handle);
     }
 
 }
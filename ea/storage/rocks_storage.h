@@ -16,7 +16,11 @@
 
 #pragma once
 
+#include <functional>
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 #include "rocksdb/db.h"
 #include "rocksdb/convenience.h"
 #include "rocksdb/slice.h"
@@ -25,6 +29,7 @@
 #include "rocksdb/options.h"
 #include "rocksdb/status.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/write_buffer_manager.h"
 #include "rocksdb/utilities/transaction.h"
 #include "rocksdb/utilities/transaction_db.h"
 #include "turbo/format/format.h"
@@ -39,6 +44,7 @@ namespace EA {
         static const std::string RAFT_LOG_CF;
         static const std::string DATA_CF;
         static const std::string META_INFO_CF;
+        static const std::string ACTIVE_META_INFO_CF_KEY;
         static std::atomic<int64_t> raft_cf_remove_range_count;
         static std::atomic<int64_t> data_cf_remove_range_count;
         static std::atomic<int64_t> mata_cf_remove_range_count;
@@ -137,6 +143,15 @@ namespace EA {
 
         rocksdb::ColumnFamilyHandle *get_meta_info_handle();
 
+        /// creates an empty meta info column family, a snapshot is installed into it before swap_meta_info_handle
+        rocksdb::ColumnFamilyHandle *create_meta_info_handle();
+
+        /// makes the handle the meta info column family, persisted in the default column family,
+        /// and drops the one it replaces
+        int32_t swap_meta_info_handle(rocksdb::ColumnFamilyHandle *handle);
+
+        void drop_meta_info_handle(rocksdb::ColumnFamilyHandle *handle);
+
         rocksdb::TransactionDB *get_db() {
             return _txn_db;
         }
@@ -157,6 +172,11 @@ namespace EA {
             return _cache;
         }
 
+        /// the block cache of the meta info column family, the shared one if rocks_meta_block_cache_size_mb is not set
+        rocksdb::Cache *get_meta_cache() {
+            return _meta_cache;
+        }
+
         const rocksdb::Snapshot *get_snapshot() {
             return _txn_db->GetSnapshot();
         }
@@ -218,6 +238,11 @@ namespace EA {
 
         void collect_rocks_options();
 
+        /// applies the options keyed by their gflag names, see collect_rocks_options, to the running db.
+        /// the column family options go to the data and the meta info column families, the others to the db.
+        /// an option with the value applied already is skipped
+        int32_t adjust_option(const std::map<std::string, std::string> &new_options);
+
         int get_rocks_statistic(uint64_t &level0_sst, uint64_t &pending_compaction_size) {
             rocksdb::ColumnFamilyMetaData cf_meta;
             _txn_db->GetColumnFamilyMetaData(get_data_handle(), &cf_meta);
@@ -232,16 +257,36 @@ namespace EA {
 
     private:
 
+        struct MemoryMetric {
+            std::function<int64_t()> getter;
+            std::unique_ptr<bvar::PassiveStatus<int64_t>> status;
+        };
+
         RocksStorage();
 
+        /// exposes the usage of the block caches and the memtables, and of each column family, as bvars
+        void expose_memory_metrics();
+
+        void add_memory_metric(const std::string &name, std::function<int64_t()> getter);
+
+        static int64_t get_memory_metric(void *arg);
+
         std::string _db_path;
 
         bool _is_init;
 
         rocksdb::TransactionDB *_txn_db;
         rocksdb::Cache *_cache;
+        rocksdb::Cache *_meta_cache = nullptr;
+        /// set with rocks_memory_budget_mb, the memtables are charged to the shared block cache
+        std::shared_ptr<rocksdb::WriteBufferManager> _write_buffer_manager;
+        std::vector<std::unique_ptr<MemoryMetric>> _memory_metrics;
 
         std::map<std::string, rocksdb::ColumnFamilyHandle *> _column_families;
+        /// kept out of _column_families, it is swapped while the other threads read it
+        std::atomic<rocksdb::ColumnFamilyHandle *> _meta_info_handle{nullptr};
+        /// destroyed at the next swap, a reader may still be holding it
+        rocksdb::ColumnFamilyHandle *_retired_meta_info_handle = nullptr;
 
         rocksdb::ColumnFamilyOptions _log_cf_option;
         rocksdb::ColumnFamilyOptions _data_cf_option;
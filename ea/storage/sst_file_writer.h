@@ -37,6 +37,10 @@ namespace EA {
             return _sst_writer->Put(key, value);
         }
 
+        rocksdb::Status remove(const rocksdb::Slice &key) {
+            return _sst_writer->Delete(key);
+        }
+
         rocksdb::Status finish(rocksdb::ExternalSstFileInfo *file_info = nullptr) {
             return _sst_writer->Finish(file_info);
         }